@@ -68,6 +68,15 @@ STDOUTFILE2=/tmp/ff_rt_2_$$.out
 STDERRFILE2=/tmp/ff_rt_2_$$.err
 STDOUTDIFFS=/tmp/ff_rt_stdout_$$.dif
 STDERRDIFFS=/tmp/ff_rt_stderr_$$.dif
+EREFILE=/tmp/ff_rt_eres_$$.txt
+INDEXFILE=/tmp/ff_rt_index_$$.ffi
+QUERYFILE=/tmp/ff_rt_queries_$$.txt
+
+# EREs for -F|--pattern-from & -E|--exclude-from, one per line
+printf '%s\n' '\.conf$' '^host' 'rc$' '' 'd.*\.d$' 'pass' '(.)\1' > $EREFILE
+
+# queries for -Q|--queries, one per line
+printf '%s\n' '-r -m -30D /etc' "-dr -p 'd$' /etc" '-r -z +10000 -S /etc /usr/share/doc' > $QUERYFILE
 
 ################################################################################
 # Call the both versions of findfiles with the same arguments asyncrhonously.
@@ -134,6 +143,28 @@ for ARGS in \
     "-fv -A -/etc/vimrc /etc" \
     "-fv -A  /etc/vimrc /etc" \
     "-fv -A +/etc/vimrc /etc" \
+    "-fv -b  -30D /etc" \
+    "-fv -b   30D /etc" \
+    "-fvy -m -30D /etc" \
+    "-fv --no-sync -m -30D /etc" \
+    "-fvr -q 32 -m -30D /etc" \
+    "-fvr -l 10 /etc" \
+    "-fvrSR -l 10 /etc" \
+    "-fvO /etc" \
+    "-fv --no-sort /etc" \
+    "-fdvr -I $INDEXFILE -m -30D /etc" \
+    "-fdvr --index=$INDEXFILE -S /etc" \
+    "-fdv --i -I $INDEXFILE /etc" \
+    "-fv -Q $QUERYFILE" \
+    "-fvr -m -3000D -a 1D /etc" \
+    "-fvr -C -3000D -k a -S /etc" \
+    "-fvr -z 1000..100000 -m 3000D..1D /etc" \
+    "-fvr -U root -e -z -1000 -G -m -30D /etc" \
+    "-fdr -K '^ssl$' --prune='\.d$' /etc" \
+    "-dr -Y -D 2 --skip-fstype=proc,sysfs /" \
+    "-fdr -Z /etc /etc/ssl --unique /etc/ssl" \
+    "-fdor -D 1000 /usr/share/doc /etc" \
+    "-fdorT -l 20 -S /usr/share /dev" \
 \
     "-fvsu  /etc" \
     "-fvsu  -m   30D /etc" \
@@ -167,6 +198,7 @@ for ARGS in \
     "-fvR -A -/etc/vimrc /etc" \
 \
     "-fvrn -m -3D /etc" \
+    "-fvrn -j 4 -m -3D /etc" \
 \
     "-fd /etc" \
     "-fdr -D 0 /etc" \
@@ -177,6 +209,9 @@ for ARGS in \
     "-dfvr -ip e -t /etc/X11" \
     "-fp '^[ghp]' -X '^group$' -X '^passwd-$' /etc" \
     "-fp '^tty' /dev -p ^passwd /etc" \
+    "-fr -ip 'CONF$' -x '^host' -x 'd.*\.conf' /etc" \
+    "-fr -F $EREFILE /etc" \
+    "-fdr -i --exclude-from $EREFILE -X '^s' /etc" \
 \
     "-vfh /etc" \
     "-vfH /etc" \
@@ -247,6 +282,8 @@ for ARGS in \
     "--files --verbose --reverse --acc-ref -/etc/vimrc /etc" \
 \
     "--files --verbose --recursive --nanoseconds --mod-info -3D /etc" \
+    "--files --verbose --recursive --nanoseconds --jobs 4 --mod-info -3D /etc" \
+    "--files --verbose --recursive --nanoseconds --jobs 4 --queue-depth 16 --mod-info -3D /etc" \
 \
     "--files --directories /etc" \
     "--files --directories --recursive --depth 0 /etc" \
@@ -297,6 +334,6 @@ echo "==============================================="
 echo "$DIFFCOUNT differences/problems/errors"
 echo "==============================================="
 
-rm -f $STDOUTFILE1 $STDERRFILE1 $STDOUTFILE2 $STDERRFILE2 $STDOUTDIFFS $STDERRDIFFS
+rm -f $STDOUTFILE1 $STDERRFILE1 $STDOUTFILE2 $STDERRFILE2 $STDOUTDIFFS $STDERRDIFFS $EREFILE $INDEXFILE $QUERYFILE
 
 exit 0
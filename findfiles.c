@@ -71,24 +71,44 @@ Note that "-m" and "-a" use <= and/or >=, but "-M" and "-A" use < and/or >!
 It is assumed that, in general, the cases of file system objects having future
 last access and/or last modification times are both rare and uninteresting.
 *******************************************************************************/
-#define PROGRAMVERSIONSTRING	"3.7.3"
+#define PROGRAMVERSIONSTRING	"3.8.0"
 
 #define _GNU_SOURCE		/* required for strptime */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <stdarg.h>
+#include <limits.h>
 #include <unistd.h>
 #include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <fcntl.h>
 #include <time.h>
 #include <locale.h>
 #include <dirent.h>
 #include <regex.h>
 #include <ctype.h>
 #include <pwd.h>
-#include <sys/resource.h>
+#include <pthread.h>
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <sys/inotify.h>
+#include <sys/sysmacros.h>
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#endif
+#endif
+#endif
 
 #define SECONDSPERMINUTE	60
 #define MINUTESPERHOUR		60
@@ -106,12 +126,29 @@ last access and/or last modification times are both rare and uninteresting.
 #define MAXRECURSIONDEPTH	256
 #define MAXDATESTRLENGTH	64
 #define MAXPATHLENGTH		4096
+#define MAXDIRPATHLENGTH	(MAXPATHLENGTH-NAME_MAX-2)	/* so the pathnames of a directory's entries fit */
 #define INITMAXNUMOBJS		(  8*1024)	/* Allocate the object table to hold up to this many entries. */
 #define MAXNUMOBJSMLTFCT	2		/* Dynamically increase the object table size by this factor... */
 #define MAXNUMOBJSMLTLIM	(512*1024)	/* up to this number. After that, ... */
 #define MAXNUMOBJSINCVAL	( 64*1024)	/* increment the size by this value. */
+#define MAXNUMTHREADS		256		/* Maximum number of tree traversal threads (-j) */
+#define INITDIRDEQUESIZE	64		/* Initial size of each thread's directory deque */
+#define INITSKIPDEVICES		8		/* -W: initial size of the table of devices not traversed */
+#define INITUNIQUETABLESIZE	4096		/* -Z: initial size (a power of 2) of the found objects hash table */
+#define MAXURINGQUEUEDEPTH	4096		/* Maximum io_uring queue depth (-q) */
+#define NAMEARENASIZE		(1024*1024)	/* Allocate object names in blocks of this size */
+#define INDEXMAGICSTR		"findfiles index v1\n"	/* -I: the first bytes of an index file */
+#define INDEXBUFSIZE		(1024*1024)	/* write index files via a stdio buffer of this size */
+#define INDEXALIGN(n)		(((n)+7) & ~(size_t)7)	/* index file records are 8 byte aligned */
+#define INDEXHEADERSIZE		INDEXALIGN(sizeof(Indexheader))
+#define UNSTABLEMTIME_NS	-1		/* index directory mtime that never matches */
 #define PATHDELIMITERCHAR	'/'
 #define MODTIMEINFOCHAR		'm'
+#define ACCTIMEINFOCHAR		'a'
+#define CHGTIMEINFOCHAR		'C'
+#define BIRTHTIMEINFOCHAR	'b'
+#define TIMEINFOCHARS		"maCb"	/* in Objectinfo objecttimes_s/_ns order (see get_time_index) */
+#define NUMTIMEKINDS		4
 #define REFMODTIMECHAR		'M'
 #define SECONDSUNITCHAR		's'
 #define BYTESUNITCHAR		'B'
@@ -122,14 +159,101 @@ last access and/or last modification times are both rare and uninteresting.
 #define NOWSTR			"Now"
 #define SECONDSFORMATSTR	"%S"
 #define FF_STARTTIMESTR		"FF_STARTTIME"
+#define FF_DIRBUFSIZESTR	"FF_DIRBUFSIZE"
+#define FF_AGEFORMATSTR		"FF_AGEFORMAT"
+#define FF_DATETIMEFORMATSTR	"FF_DATETIMEFORMAT"
+#define DEFAULTDIRBUFSIZESTR	"262144"	/* 256kiB */
+#define MINDIRBUFSIZE		4096
+#define MAXDIRBUFSIZE		(64*1024*1024)
+#define RANGESEPARATORSTR	".."		/* eg, -z 1000..2000 or -m 30D..7D */
+#define MINTIME_S		LONG_MIN	/* the bounds of one-sided time & size ranges */
+#define MAXTIME_S		LONG_MAX
+#define MAXOBJECTSIZE		((off_t)LLONG_MAX)
+#define SORTKEYSIGNBIT		(1ULL << 63)	/* flipped to sort signed values as unsigned */
+#define OUTPUTBUFSIZE		(256*1024)	/* list objects' lines via a buffer of this size */
+#define MAXINTEGERLENGTH	32		/* format_integer: max digits+sign+padding */
+#define SORTSAMPLESPERTHREAD	64		/* sample sort: objects sampled per sorting thread */
+#define FF_PARALLELSORTSTR	"FF_PARALLELSORT"
+#define DEFAULTPARALLELSORTSTR	"1000000"	/* sort with several threads from this many objects */
 #define DEFAULTTIMESTAMPFMT	"%Y%m%d_%H%M%S"
+#define DEFAULTAGEFORMAT	"%7ldD_%02ld:%02ld:%02ld"
+#define DEFAULTDATETIMEFORMAT	"%04d%02d%02d_%02d%02d%02d"
 
-#define	SELECTSMALLERSIZES	-1
-#define	SELECTALLSIZES		0
-#define	SELECTLARGERSIZES	1
 #define SELECTALLUSERS		-1
 #define REJECTALLUSERS		-2
 
+/* Directory entry types (d_type) let objects be classified without stat. Where they
+are not available (eg, AIX), every entry's type is "unknown" and stat is used. */
+#ifdef DT_UNKNOWN
+#define DIRENTTYPE(direntptr)	((direntptr)->d_type)
+#else
+#define DT_UNKNOWN		0
+#define DIRENTTYPE(direntptr)	DT_UNKNOWN
+#endif
+#ifndef DTTOIF
+#define DTTOIF(direnttype)	((direnttype) << 12)	/* d_type to the (st_mode) S_IF... bits */
+#endif
+
+/* statx (Linux) fetches only the requested fields (a mask of STATX_... bits) and can be
+told not to make network file systems refresh them. Elsewhere, fstatat is used instead:
+it fetches all the fields (except the birth time), and the same mask bits are defined. */
+#ifdef STATX_BASIC_STATS
+#define HAVESTATX		1
+#else
+#define HAVESTATX		0
+#define STATX_TYPE		0x0001U
+#define STATX_MODE		0x0002U
+#define STATX_UID		0x0008U
+#define STATX_ATIME		0x0020U
+#define STATX_MTIME		0x0040U
+#define STATX_CTIME		0x0080U
+#define STATX_INO		0x0100U
+#define STATX_SIZE		0x0200U
+#define STATX_BASIC_STATS	0x07ffU
+#define STATX_BTIME		0x0800U
+#endif
+
+/* On Linux, directories are read with getdents64 directly into large (FF_DIRBUFSIZE)
+buffers, and the entries are processed in place. Elsewhere (eg, AIX & Cygwin), readdir is used. */
+#if defined(__linux__) && defined(SYS_getdents64)
+#define HAVEGETDENTS64		1
+#else
+#define HAVEGETDENTS64		0
+#endif
+
+/* On Linux 5.6 and later, the entries of each directory buffer can be stat'ed in batches of
+up to queue depth (-q) statx requests with io_uring - so with one system call per batch. */
+#if HAVEGETDENTS64 && HAVESTATX && defined(IORING_FEAT_CUR_PERSONALITY) && defined(__NR_io_uring_setup)
+#define HAVEIOURING		1
+#else
+#define HAVEIOURING		0
+#endif
+
+#ifndef AT_NO_AUTOMOUNT
+#define AT_NO_AUTOMOUNT		0
+#endif
+#define MOUNTINFOFILENAME	"/proc/self/mountinfo"	/* -W: the mounted file systems & their types */
+#define MAXMOUNTINFOLINELENGTH	(2*PATH_MAX)
+
+/* On Linux, -w/--watch (daemon mode) keeps the information of the watched trees current with inotify */
+#if defined(__linux__) && defined(IN_ONLYDIR)
+#define HAVEINOTIFY		1
+#else
+#define HAVEINOTIFY		0
+#endif
+#define WATCHEVENTMASK		(IN_CREATE|IN_DELETE|IN_MOVED_FROM|IN_MOVED_TO|IN_ATTRIB|IN_MODIFY|IN_ACCESS|\
+				IN_DELETE_SELF|IN_MOVE_SELF|IN_ONLYDIR)
+#define WATCHQUERYBADOPTIONS	"IQFEwc"	/* options that can't be used in -c queries (files, daemons) */
+#define WATCHEVENTBUFSIZE	(64*1024)
+#define WATCHLISTENBACKLOG	16
+#define WATCHREJECTEDCODE	255	/* the answer to a query from another user */
+#define STATNOTNEEDED		1	/* Batchentry statresult values (statx results are 0 or -errno) */
+#define STATPENDING		2
+#define NAMEMATCHUNKNOWN	-1	/* namematch value: match_object_name has not been called yet */
+
+/* Is this directory entry name "." or ".."? */
+#define ISDOTORDOTDOT(name)	((name)[0] == '.' && ((name)[1] == '\0' || ((name)[1] == '.' && (name)[2] == '\0')))
+
 #if defined(__LP64__) || defined(_WIN64) || defined(__x86_64__) || defined(__ppc64__) || defined(__arm64__)
     typedef size_t	size64_t;	/* 64-bit systems */
 #else
@@ -147,11 +271,15 @@ char	*datetimeformatstr;
 char	*ageformatstr;
 char	*infodatetimeformatstr;
 char	*timestampformatstr;
+char	*dirbuffersizestr;
+char	*parallelsortstr;
 
 Envvar envvartable[] = {
-    { "FF_AGEFORMAT",		"%7ldD_%02ld:%02ld:%02ld",	&ageformatstr },
-    { "FF_DATETIMEFORMAT",	"%04d%02d%02d_%02d%02d%02d",	&datetimeformatstr },
+    { FF_AGEFORMATSTR,		DEFAULTAGEFORMAT,		&ageformatstr },
+    { FF_DATETIMEFORMATSTR,	DEFAULTDATETIMEFORMAT,		&datetimeformatstr },
+    { FF_DIRBUFSIZESTR,		DEFAULTDIRBUFSIZESTR,		&dirbuffersizestr },
     { "FF_INFODATETIMEFORMAT",	"%a %b %d %H:%M:%S %Y %Z %z",	&infodatetimeformatstr },
+    { FF_PARALLELSORTSTR,	DEFAULTPARALLELSORTSTR,		&parallelsortstr },
     { FF_STARTTIMESTR,		NOWSTR,				&starttimestr },
     { "FF_TIMESTAMPFORMAT",	DEFAULTTIMESTAMPFMT,		&timestampformatstr },
 };
@@ -185,16 +313,337 @@ Unitinfo humanunit1000table[] = {
 Unitinfo	*humanunittable	= NULL;
 size_t		numhumanunits;
 
-typedef struct {	/* each object's name, modification XOR access time & size */
+/* The objects' lines are formatted into outputbuffer, which is written when it's full */
+char		outputbuffer[OUTPUTBUFSIZE];
+size_t		outputlength	= 0;
+int		defaultdatetimeformatflag;
+int		defaultageformatflag;
+
+typedef struct {	/* each object's name, times & size */
     char	*name;
-    time_t	time_s;
+    time_t	time_s;		/* the listed (and sorted by) time */
     time_t	time_ns;
+    time_t	objecttimes_s[NUMTIMEKINDS];	/* modification, access, change & birth times (see TIMEINFOCHARS), */
+    time_t	objecttimes_ns[NUMTIMEKINDS];	/* DEFAULTAGE unless statmask has their STATX_... bit */
     off_t	size;
     uid_t	uid;
     mode_t	type;
+    dev_t	device;		/* -Z: the object's identity (only with STATX_INO) */
+    ino_t	inode;
+    unsigned	statmask;	/* the STATX_... fields fetched so far */
+    char	timeinfochar;	/* time_s & time_ns are the MODTIMEINFOCHAR, ACCTIMEINFOCHAR, CHGTIMEINFOCHAR or BIRTHTIMEINFOCHAR time */
 } Objectinfo;
 
-Objectinfo	*objectinfotable;
+/* The selection predicates set by the options, in order: one (the last) per kind of time (-a, -b,
+-C, -m, -A & -M), size (-z) & user (-U) - unless OR'ed. Each is a (closed) range, or a uid. -e|--not
+negates the next one, and -G|--or ORs it with the previous one (otherwise they are AND'ed). As
+options apply to the targets that follow them, the first time predicate set after a target
+replaces all the previous ones (as does a size or user predicate, for those of its kind). */
+#define PREDTIME		0
+#define PREDSIZE		1
+#define PREDUID			2
+#define MAXNUMPREDICATES	32
+
+typedef struct {
+    int		kind;			/* PREDTIME, PREDSIZE or PREDUID */
+    int		timeidx;		/* PREDTIME: of the time in Objectinfo objecttimes_s/_ns */
+    int		negateflag;
+    int		orflag;			/* OR'ed with the previous predicate */
+    time_t	lowtime_s, lowtime_ns;	/* PREDTIME */
+    time_t	hightime_s, hightime_ns;
+    off_t	lowsize, highsize;	/* PREDSIZE */
+    uid_t	uid;			/* PREDUID */
+} Selectpredicate;
+
+/* The selection predicates are compiled (see compile_predicate_program) into a program: its
+operations are grouped into ORs (the AND of which selects an object), and the groups are ordered
+cheapest & most selective first, so most objects that are rejected are rejected early. */
+#define OPUIDEQUAL		0
+#define OPSIZERANGE		1
+#define OPTIMERANGE		2
+
+typedef struct {
+    int		opcode;			/* OPUIDEQUAL, OPSIZERANGE or OPTIMERANGE */
+    int		negateflag;		/* (ie, the result that fails) */
+    int		nextgroupidx;		/* the operation to continue with if this one is true */
+    int		lastingroupflag;	/* if this one is false too, the object is rejected */
+    int		timeidx;
+    time_t	lowtime_s, lowtime_ns;
+    time_t	hightime_s, hightime_ns;
+    off_t	lowsize, highsize;
+    uid_t	uid;
+} Predicateop;
+
+Selectpredicate	selectpredicatetable[MAXNUMPREDICATES];
+int		numselectpredicates	= 0;
+int		negatenextflag		= 0;	/* -e|--not */
+int		ornextflag		= 0;	/* -G|--or */
+int		resetpredicatekinds	= 0;	/* (1 << PRED...) kinds to replace (a target was processed) */
+Predicateop	predicateprogram[MAXNUMPREDICATES];
+int		numpredicateops		= 0;
+const unsigned	timestatmasktable[NUMTIMEKINDS] = { STATX_MTIME, STATX_ATIME, STATX_CTIME, STATX_BTIME };
+
+/* The selected objects are kept in an object table with one array per column (rather than an
+array of Objectinfo), so sorting and listing only touch the columns they need, and only the
+columns that are needed are allocated: the listed time & size columns are allocated when the
+first object with that information is stored (see store_object). fetchcodes record each
+object's listed time kind and which of its columns are set (see stat_pending_objects). */
+#define OBJTIMEINDEXMASK	0x03		/* fetchcode: the listed time's index (see TIMEINFOCHARS) */
+#define OBJTIMEFETCHED		0x04		/* fetchcode: times_s & times_ns are set */
+#define OBJSIZEFETCHED		0x08		/* fetchcode: sizes is set */
+#define NUMTYPECODES		8
+
+typedef struct {
+    char		**names;
+    time_t		*times_s;	/* the listed (and sorted by) time, or NULL */
+    uint32_t		*times_ns;
+    off_t		*sizes;		/* or NULL */
+    unsigned char	*typecodes;	/* see get_type_code */
+    unsigned char	*fetchcodes;
+    int			numobjs;
+    int			maxnumobjs;
+} Objecttable;
+
+Objecttable	objecttable;		/* (the tree traversal threads have their own) */
+int		*sortedidxtable	= NULL;	/* the objecttable indexes, in sort order (see sort_objects) */
+
+/* get_type_code: the S_IF... types, in order of expected frequency, and their -T names */
+const mode_t	typecodemodetable[NUMTYPECODES] = { S_IFREG, S_IFDIR, S_IFLNK, S_IFBLK, S_IFCHR, S_IFIFO, S_IFSOCK, 0 };
+const char	typecodenametable[NUMTYPECODES][5] = { "Fil ", "Dir ", "Sln ", "Blk ", "Chr ", "FIF ", "Soc ", "Oth " };
+
+typedef struct {	/* an object's packed sort key (see sort_objects) */
+    uint64_t	hi;
+    uint64_t	lo;
+    int		idx;		/* the object's objecttable index */
+} Sortkey;
+
+typedef struct {	/* an object's collation key (strxfrm) for sorting by name */
+    size_t	offset;		/* in the key buffer... */
+    const char	*key;		/* which is here (once all the keys are in the buffer) */
+    int		idx;
+} Namekey;
+
+typedef struct {	/* a thread sorting part of objecttable (see sort_objects_in_parallel) */
+    pthread_t	thread;
+    int		threadidx;
+    char	*namekeybuffer;
+    size_t	namekeybuffersize;
+} Sorterinfo;
+
+char	*namekeybuffer		= NULL;		/* (single threaded sorting) */
+size_t	namekeybuffersize	= 0;
+Sorterinfo	*sortertable;
+int		numsorters;
+Sortkey		*splittertable;			/* numsorters-1 splitters' sort keys... */
+char		**splitternametable;		/* and names */
+unsigned char	*objectbuckettable;		/* each object's bucket */
+int		*bucketedtable;			/* the objecttable indexes, in bucket order */
+int		*bucketcounttable;		/* [sorteridx][bucketidx] counts, then positions */
+pthread_barrier_t	sorterbarrier;
+long		parallelsortminimum;		/* FF_PARALLELSORT */
+
+/* Selected objects' names are never freed, so they are allocated consecutively from large
+blocks (arenas) instead of one malloc each. Each tree traversal thread has its own arena. */
+typedef struct {
+    char	*nextnameptr;
+    size_t	numbytesleft;
+} Namearena;
+
+Namearena	namearena = { NULL, 0 };
+
+/* -L: each directory being read is linked to the one it was found in (back to the target), so a
+symbolic link to any of them - a loop - is not followed. The directories waiting to be read are
+linked to theirs, so these are kept (in a list per thread) until the traversal has finished. */
+typedef struct Dirnode Dirnode;
+struct Dirnode {
+    dev_t	device;
+    ino_t	inode;
+    Dirnode	*parentptr;
+    Dirnode	*nextallocatedptr;
+};
+
+Dirnode		*currentdirnodeptr	= NULL;	/* -L: the directory being read (one thread) */
+Dirnode		*allocateddirnodes	= NULL;	/* -L: all those read (one thread) */
+
+typedef struct {	/* a directory waiting to be read by one of the tree traversal threads */
+    char	*pathname;
+    int		recursiondepth;
+    dev_t	device;		/* (only set when it's needed: see check_directory_device) */
+    Dirnode	*parentnodeptr;	/* -L: the directory it was found in */
+    time_t	mtime_s;	/* -I: its mtime (see traverse_indexed_directory) */
+    time_t	mtime_ns;
+    struct Watchdirectory *watchdirptr;	/* -w: the watched directory it was found in, or that it is */
+} Diritem;
+
+Diritem		*dirstack		= NULL;	/* the directories waiting to be read (one thread): see traverse_directory */
+int		numstackeddirs		= 0;
+int		dirstacksize		= 0;
+
+/* -Z/--unique: the identities of all the objects found so far, so each is listed (and each directory
+read) once, however many paths lead to it. An open addressing hash table. Trees are traversed with one
+thread (-j is ignored), so the path listed is the first one found in the serial order. */
+typedef struct {
+    dev_t	device;
+    ino_t	inode;		/* (0 with device 0: a free entry) */
+} Objectid;
+
+Objectid	*uniquetable		= NULL;
+size_t		uniquetablesize		= 0;	/* a power of 2 */
+size_t		numuniqueobjects	= 0;
+pthread_mutex_t	uniquelock		= PTHREAD_MUTEX_INITIALIZER;
+int		uniqueflag		= 0;
+
+typedef struct {	/* -J: the number of threads reading directories on a device */
+    dev_t	device;
+    int		numthreads;
+} Deviceslot;
+
+#if HAVEIOURING
+typedef struct {	/* an io_uring instance: its ring file descriptor & the (mmap'ed) rings */
+    int			ringfiledes;	/* -1: not set up */
+    unsigned		numentries;
+    unsigned		*sqtailptr, *sqmaskptr, *sqarray;
+    unsigned		*cqheadptr, *cqtailptr, *cqmaskptr;
+    struct io_uring_sqe	*sqes;
+    struct io_uring_cqe	*cqes;
+    void		*sqringptr, *cqringptr;
+    size_t		sqringsize, cqringsize, sqessize;
+} Uringinfo;
+
+typedef struct {	/* a directory entry in a batch to be stat'ed with io_uring */
+    char		*name;
+    unsigned char	direnttype;
+    int			statresult;	/* 0, -errno, STATNOTNEEDED or STATPENDING */
+    int			namematch;	/* match_object_name's result, or NAMEMATCHUNKNOWN */
+    struct statx	statxinfo;
+    Objectinfo		objectinfo;
+} Batchentry;
+
+Uringinfo	mainuring = { -1, 0, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, 0, 0, 0 };
+#endif
+
+/* Each tree traversal thread has its own double-ended queue (deque) of directories and its own
+object table. The owner pushes and pops directories at the tail (depth first), idle threads steal
+them from the head. The per-thread object tables are merged into objecttable afterwards. */
+typedef struct {
+    pthread_t		thread;
+    int			threadidx;
+    pthread_mutex_t	dequelock;
+    Diritem		*dirdeque;
+    int			dequehead;
+    int			dequetail;
+    int			dequesize;
+    Objecttable		objecttable;
+    char		*dirbuffer;
+    Namearena		namearena;
+    Dirnode		*dirnodeptr;		/* -L: the directory being read */
+    Dirnode		*allocateddirnodes;	/* -L: all those read by this thread */
+#if HAVEIOURING
+    Uringinfo		uring;
+#endif
+} Workerinfo;
+
+/* -I/--index: a target's persistent index file holds the information of every object in its tree,
+directory by directory. A directory whose mtime hasn't changed since the index was written is not
+read again: its entries are taken from the index, and only those that are selected or traversed
+are stat'ed again (writing to a file doesn't change its directory's mtime). */
+typedef struct {	/* an index file's (padded) header, followed by the target's pathname (padded) */
+    char	magicstr[sizeof(INDEXMAGICSTR)];
+    unsigned	entrysize;		/* sizeof(Indexentry): index files are only read by the same build */
+    unsigned	targetsize;		/* padded target pathname size */
+} Indexheader;
+
+typedef struct {	/* a directory in an index file, followed by its pathname (relative to the target) & entries */
+    time_t	mtime_s;
+    time_t	mtime_ns;		/* UNSTABLEMTIME_NS: it may have changed in the same (mtime) second */
+    size_t	relpathsize;		/* padded relative pathname size */
+    size_t	entriessize;		/* the total size of the entries */
+} Indexdirectory;
+
+typedef struct {	/* a directory entry in an index file, followed by its name (padded) */
+    time_t	atime_s, atime_ns;
+    time_t	mtime_s, mtime_ns;
+    time_t	ctime_s, ctime_ns;
+    time_t	btime_s, btime_ns;	/* DEFAULTAGE unless statmask has STATX_BTIME */
+    off_t	size;
+    uid_t	uid;
+    mode_t	type;
+    unsigned	statmask;
+    unsigned	namesize;		/* padded name size */
+} Indexentry;
+
+char		*indexfilename		= NULL;	/* -I: the index file for the next target */
+char		*indexbuffer		= NULL;	/* the (previous) index file's contents */
+const Indexdirectory	**indexhashtable = NULL;	/* its directories, hashed by relative pathname */
+size_t		indexhashsize		= 0;
+FILE		*newindexfileptr;
+size_t		indextargetlength;
+time_t		indexrefreshtime_s;
+long		numindexdirsread, numindexdirsreused;
+
+/* -w/--watch: the daemon holds the entries (as in index files) of every directory in the watched
+trees in memory, hashed by pathname, and refreshes those that inotify reports have changed. */
+typedef struct Watchdirectory Watchdirectory;
+struct Watchdirectory {
+    char		*pathname;	/* real pathname */
+    const char		*name;		/* (in pathname) */
+    Watchdirectory	*parentptr;	/* NULL for a watched target */
+    Watchdirectory	*hashnextptr;
+    char		*entries;	/* Indexentry + name, ... */
+    size_t		entriessize;
+    int			watchdes;	/* inotify watch descriptor, -1 if not watched (refresh before each query) */
+    int			dirtyflag;
+    int			removedflag;
+    long		generation;	/* of the last refresh of its parent that found it */
+};
+
+char		*watchsocketname	= NULL;	/* -w: targets are watched, not searched */
+int		watchqueryflag		= 0;	/* this process answers a -c query (see answer_query) */
+int		numqueryoptions		= 0;	/* options other than -w, -v & -t (see run_daemon) */
+char		*queryfilename		= NULL;	/* -Q: batch queries */
+Watchdirectory	**watchhashtable	= NULL;
+size_t		watchhashsize		= 0;
+size_t		numwatchdirs		= 0;
+Watchdirectory	**watchdestable		= NULL;	/* indexed by inotify watch descriptor */
+int		maxwatchdes		= 0;
+Watchdirectory	**dirtywatchtable	= NULL;	/* directories to refresh */
+size_t		numdirtywatchdirs	= 0;
+size_t		maxdirtywatchdirs	= 0;
+Watchdirectory	*removedwatchlistptr	= NULL;	/* freed after each refresh */
+long		watchgeneration		= 0;
+long		numunwatcheddirs	= 0;
+int		inotifyfiledes		= -1;
+int		watchlimitwarningflag	= 0;
+
+Workerinfo	*workertable;
+pthread_mutex_t	pendingdirslock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t	pendingdirscond = PTHREAD_COND_INITIALIZER;
+long		numpendingdirs;		/* directories queued or being read by a thread */
+long		numdirspushed;		/* incremented whenever a directory is queued */
+long		numdeviceslotsfreed;	/* -J: incremented whenever a thread finishes a directory */
+Deviceslot	*deviceslottable	= NULL;	/* -J (all protected by pendingdirslock) */
+int		numdeviceslots		= 0;
+int		maxdeviceslots		= 0;
+int		maxdevicethreads	= 0;	/* -J: per device (0: any number) */
+
+int		xdevflag		= 0;	/* -Y: don't traverse directories on other devices */
+dev_t		targetdevice;		/* the device of the current target */
+dev_t		*skipdevicetable	= NULL;	/* -W: the devices of the file systems not traversed */
+int		numskipdevices		= 0;
+int		devicecheckflag		= 0;	/* -Y, -W or -J: directories' devices are needed */
+
+size_t	dirbuffersize;		/* FF_DIRBUFSIZE */
+char	*maindirbuffer		= NULL;	/* (single threaded) the buffer directories are read into */
+
+/* localtime_r results are reused for all the times in the same (local) day */
+typedef struct {
+    int		validflag;
+    time_t	daystart_s;	/* the time at local midnight... */
+    struct tm	daytimeinfo;	/* broken down */
+} Localtimecache;
+
+Localtimecache	outputtimecache	= { 0 };	/* list_object */
+Localtimecache	infotimecache	= { 0 };	/* convert_time_s_to_date_string */
 
 time_t	starttime_s;
 time_t	starttime_ns;
@@ -202,23 +651,69 @@ time_t	targettime_s	= DEFAULTAGE;	/* set default, 0 s, and */
 time_t	targettime_ns	= DEFAULTAGE;	/* 0 ns - find files of all ages */
 
 /* ERE: Extended Regular Expression */
-#define MAXNUMERES		4
+#define INITMAXNUMERES		4
+#define ERELITERALNONE		0	/* no usable literal: always call regexec */
+#define ERELITERALFILTER	1	/* names without the literal can't match, regexec decides the rest */
+#define ERELITERALCONTAINS	2	/* the ERE is just 'literal' */
+#define ERELITERALPREFIX	3	/* the ERE is just '^literal' */
+#define ERELITERALSUFFIX	4	/* the ERE is just 'literal$' */
+#define ERELITERALEXACT		5	/* the ERE is just '^literal$' */
+typedef struct Ereset Ereset;
 typedef struct {		/* preg: pre-compiled (extended) regular expression pattern buffer */
     regex_t	compiledere;	/* compiled ERE (preg) */
     int		matchcode;	/* REG_MATCH or REG_NOMATCH */
+    int		literalkind;	/* ERELITERALNONE, ERELITERALFILTER, etc. */
+    int		icaseflag;	/* compiled with REG_ICASE: literal is lower case, compare folding ASCII case */
+    int		multibyteflag;	/* multibyte locale: names with non-ASCII bytes need regexec to confirm a match */
+    char	*literal;	/* ASCII string that every matching name contains */
+    size_t	literallength;
+    Ereset	*ereset;	/* -E/-F: the EREs read from a file (compiledere is unused), NULL for -p/-P/-x/-X */
 } Ereinfo;
 
-Ereinfo	eretable[MAXNUMERES];
+#define NUMACCHARS		128	/* literals are ASCII: Aho-Corasick transitions for ASCII bytes only */
+typedef struct {		/* Aho-Corasick automaton node (trie node + failure transitions = a DFA) */
+    int		next[NUMACCHARS];	/* next node for each (ASCII) input byte */
+    int		memberidx;	/* first member whose literal ends at this node, -1 if none */
+    int		dictnode;	/* nearest node (via failure links) at which a member's literal ends, -1 if none */
+} Acnode;
+
+struct Ereset {			/* EREs read from a file: a name matches the set if it matches any of them */
+    Ereinfo	*membertable;	/* each member ERE with its literal (see set_ere_literal) */
+    int		*nextmembertable;	/* next member whose literal ends at the same Acnode, -1 if none */
+    int		nummembers;
+    int		numnoliteralmembers;	/* members without a literal: regexec is always needed */
+    Acnode	*acnodetable;	/* one pass over the name finds all the members' literals */
+    int		numacnodes;
+    regex_t	*restregextable;	/* members not decided by their literal (merged into as few as possible) */
+    int		numrestregexes;
+    regex_t	*allregextable;	/* all members (merged), for names the automaton can't decide */
+    int		numallregexes;
+    int		icaseflag;
+    int		multibyteflag;
+};
+
+Ereinfo	*eretable		= NULL;
 int	numeres			= 0;
+int	maxnumeres		= 0;
+Ereinfo	*prunetable		= NULL;	/* -K: directories whose names match any of these aren't traversed */
+int	numprunes		= 0;
+int	maxnumprunes		= 0;
 
-int	maxnumberobjects	= INITMAXNUMOBJS;
-int	numobjsfound		= 0;
 int	numtargets		= 0;
 int	returncode		= 0;
-int 	filedescriptorsavailable;
 
 /* Command line option flags - all set to false */
+unsigned objectstatmask		= STATX_BASIC_STATS;	/* set by plan_object_stats */
 int	maxrecursiondepth	= MAXRECURSIONDEPTH;
+int	numthreads		= 1;
+int	objectlimit		= 0;
+int	limitheapflag		= 0;
+int	limitprunedflag		= 0;
+int	nosortflag		= 0;
+int	numobjslisted		= 0;	/* -O/--no-sort */
+pthread_mutex_t	outputlock	= PTHREAD_MUTEX_INITIALIZER;
+int	uringqueuedepth		= 0;
+int	uringwarningflag	= 0;
 int	recursiveflag		= 0;
 int	ignorecaseflag		= 0;
 int	regularfileflag		= 0;
@@ -227,27 +722,59 @@ int	otherobjectflag		= 0;
 int	verbosity		= 0;
 int	displaysecondsflag	= 0;
 int	displaynsecflag		= 0;
-int	accesstimeflag		= 0;
+char	timeinfochar		= MODTIMEINFOCHAR;
+int	timekeyflag		= 0;	/* -k: timeinfochar isn't set by time predicates */
+int	nosyncflag		= 0;
+int	birthtimewarningflag	= 0;
 int	newerthantargetflag	= 0;
 int	followsymlinksflag	= 0;
 int	displaytypesflag	= 0;
 int	sortmultiplier		= 1;
-off_t	selectobjectsize	= 0;
 char	secondsunitchar		= ' ';
 char	bytesunitchar		= ' ';
 char	decimalseparatorchar	= '.';
-int	selectsizecontrol	= SELECTALLSIZES;
 uid_t	selectuid		= SELECTALLUSERS;
 
 /* function prototypes */
-void process_directory(char *, int);
+int compare_object_name_info(const void *, const void *);
+void process_directory(int, char *, const char *, int, Workerinfo *);
+void process_path(int, const char *, char *, unsigned char, int, Workerinfo *, const Objectinfo *, int);
+void process_target_with_index(char *);
+Watchdirectory *find_watched_directory(const char *);
+void process_watched_directory(Watchdirectory *, char *);
+int process_command_line(int, char *[]);
+void scan_watched_directory(const char *, Watchdirectory *);
+void remove_watched_directory(Watchdirectory *);
+void command_line_long_to_short(char *);
+void set_starttime();
+int run_predicate_program(const Objectinfo *);
+void set_time_predicate(char);
+void compile_predicate_program();
+void push_directory(Workerinfo *, const char *, int, dev_t);
+int get_time_index(char);
+void get_sort_key(const Objectinfo *, Sortkey *);
+void get_stored_sort_key(const Objecttable *, int, Sortkey *);
+int compare_sort_keys(const Sortkey *, const char *, const Sortkey *, const char *);
+int check_device(dev_t);
+int check_directory_device(int, const char *, dev_t *);
+int check_pathname_length(const char *, int);
+int insert_unique_object(dev_t, ino_t);
+size_t hash_object_id(dev_t, ino_t);
+int check_symlink_loop(const char *, const char *, const struct stat *, const Workerinfo *);
+void enter_directory(int, Workerinfo *);
+Diritem *stack_directory(const char *, int);
+void reverse_stacked_directories(int);
+void traverse_directory(char *, int);
+void leave_directory(Workerinfo *);
+void traverse_directory_in_parallel(char *);
+void list_object_unsorted(const Objectinfo *);
 int compare_object_time_info(const void *, const void *);
 int compare_object_size_info(const void *, const void *);
 
 /* Set the default object comparison function to compare by (modfication or access) time */
 int (*compare_object_function_ptr)(const void *, const void *) = &compare_object_time_info;
 
-#define GETOPTSTR		"+dforiLp:P:x:X:t:D:U:V:z:a:m:A:M:hHnsuNRSTv"
+#define GETOPTSTR		"+dforiLyYZeGp:P:x:X:E:F:K:W:J:t:D:I:w:c:Q:k:C:j:q:U:V:z:a:b:m:A:M:l:hHnsuNORSTv"
 /*******************************************************************************
 Display the usage (help) message.
 *******************************************************************************/
@@ -267,32 +794,58 @@ void display_usage_message(const char *progname) {
     printf("  -r|--recursive   : recursive - traverse file trees (default off)\n");
     printf("  -i|--ignore-case : case insensitive pattern match - use before -p|-P|-x|-X (default off)\n");
     printf("  -L|--symlinks    : follow symbolic Links (default off)\n");
+    printf("  -Z|--unique      : list each object once, however many paths (or hard links) lead to it (default off)\n");
+    printf("  -y|--no-sync     : allow cached (possibly stale) attributes on network file systems (default off)\n");
+    printf("  -Y|--xdev        : do not traverse directories on other file systems than the target's (default off)\n");
+    printf("  -e|--not         : negate the next time, size or user selection (-a|-b|-C|-m|-A|-M|-z|-U)\n");
+    printf("  -G|--or          : OR the next time, size or user selection with the previous one (default AND)\n");
     printf(" OPTIONs requiring an argument (parsed left to right):\n");
     printf("  -p|--pattern     ERE : (re)initialize name search to include objects matching this ERE\n");
     printf("  -P|--and-pattern ERE : extend name search to include objects also matching this ERE (logical and)\n");
     printf("  -x|--exclude     ERE : (re)initialize name search to exclude objects matching this ERE\n");
     printf("  -X|--and-exclude ERE : extend name search to exclude objects also matching this ERE (logical and)\n");
+    printf("  -F|--pattern-from file : extend name search to include objects matching any ERE in file (one per line)\n");
+    printf("  -E|--exclude-from file : extend name search to exclude objects matching any ERE in file (one per line)\n");
+    printf("  -K|--prune       ERE : do not traverse directories whose names match this ERE (eg, '^\\.git$')\n");
     printf("  -t|--target target_path        : target path (no default)\n");
     printf("  -D|--depth max_recursion_depth : max recursion traversal depth/level (default %d)\n", MAXRECURSIONDEPTH);
+    printf("  -j|--jobs number_of_threads    : traverse directory trees with this many threads (default 1)\n");
+    printf("  -J|--device-jobs threads       : with -j, at most this many threads read each device (default 0: any)\n");
+    printf("  -W|--skip-fstype type[,type]...: do not traverse file systems of these types (eg, nfs,proc,sysfs)\n");
+    printf("  -q|--queue-depth queue_depth   : stat objects in batches with io_uring (Linux 5.6+, default 0: off)\n");
+    printf("  -I|--index index_file          : search the next target via index_file, refreshing it first\n");
     printf("  -U|--user username|userID      : select objects owned by username|userID (eg, root or 0)\n");
+    printf("  -w|--watch socket_path         : daemon (only -v & targets): answer queries on Unix socket socket_path\n");
+    printf("  -c|--client socket_path        : query: (first OPTION only) the daemon at socket_path answers the query\n");
+    printf("  -Q|--queries query_file        : run each line's query (>output_file OPTIONs targets) in one traversal\n");
     printf("  -V|--variable=value            : for <FF_variable>=<value>\n");
     printf("  -z|--size [-|+]object_size     : - to select objects sized <= object_size, [+] for >=\n");
+    printf("  -z|--size min_size..max_size   : select objects sized >= min_size and <= max_size\n");
     printf("  Ages are relative to start time; '-3D' & '3D' both set target time to 3 days before start time\n");
     printf("   -a|--acc-info [-|+]access_age        : - for newer/=, [+] for older/= access ages (no default)\n");
+    printf("   -b|--birth-info [-|+]birth_age       : - for newer/=, [+] for older/= birth (creation) ages (no default)\n");
+    printf("   -C|--chg-info [-|+]change_age        : - for newer/=, [+] for older/= status change ages (no default)\n");
     printf("   -m|--mod-info [-|+]modification_age  : - for newer/=, [+] for older/= mod ages (default 0s: any time)\n");
     printf("  Times are absolute; eg, '-20251231_153000' & '20251231_153000' (using locale's timezone)\n");
     printf("   -a|--acc-info [-|+]access_time       : - for older/=, [+] for newer/= access times (no default)\n");
+    printf("   -b|--birth-info [-|+]birth_time      : - for older/=, [+] for newer/= birth (creation) times (no default)\n");
+    printf("   -C|--chg-info [-|+]change_time       : - for older/=, [+] for newer/= status change times (no default)\n");
     printf("   -m|--mod-info [-|+]modification_time : - for older/=, [+] for newer/= mod times (no default)\n");
     printf("  Reference times are absolute; eg: '-/tmp/f' & '/tmp/f'\n");
     printf("   -A|--acc-ref [-|+]acc_ref_path       : - for older, [+] for newer access times (no default)\n");
     printf("   -M|--mod-ref [-|+]mod_ref_path       : - for older, [+] for newer mod times (no default)\n");
+    printf("  Objects are selected by all of the (last) access, birth, change & mod times set (eg, -m -1D -a 30D)\n");
+    printf("  Ages & times can be ranges; eg, '-m 30D..7D' for objects modified between 30 & 7 days ago\n");
+    printf("  -k|--time-key m|a|C|b : list & sort by mod, access, change or birth times (default: the last set)\n");
     printf(" Flags - are 'global' options (and can NOT be toggled by setting multiple times):\n");
     printf("  -h|--human-1024   : display object sizes in 'human readable' form (eg, '1.00kiB')\n");
     printf("  -H|--human-1000   : display object sizes in 'human readable' form (eg, '1.02kB')\n");
+    printf("  -l|--limit number : only list the first number objects (in sort order) - use before targets\n");
     printf("  -n|--nanoseconds  : in verbose mode, display the maximum resolution of the OS/FS - up to ns\n");
     printf("  -s|--seconds      : display file ages in seconds (default D_hh:mm:ss)\n");
     printf("  -u|--units        : display units: s for seconds, B for Bytes (default off)\n");
     printf("  -N|--sort-by-name : sort by object name\n");
+    printf("  -O|--no-sort      : list objects as they are found (unsorted) - use before targets\n");
     printf("  -R|--reverse      : Reverse the sort order of the output (default off)\n");
     printf("  -S|--sort-by-size : sort by object size\n");
     printf("  -T|--types        : Display the type of each file/directory/other (default off)\n");
@@ -324,797 +877,5322 @@ void display_usage_message(const char *progname) {
 
 
 /*******************************************************************************
-Process a (file system) object - eg, a regular file, directory, symbolic
-link, fifo, special file, etc. If the object's attributes satisfy the command
-line arguments (i.e., the name matches the 'pattern(s)' - actually, Extended
-Regular Expression(s) or  ERE(s), the access xor modification time, etc. then,
-this object is appended to the objectinfotable. If objectinfotable is full, its
-size is dynamically increased.
-*******************************************************************************/
-void process_object(char *pathname) {
-    struct	stat statinfo;
-    char	objectname[MAXPATHLENGTH], *chptr;
-    time_t	objecttime_s, objecttime_ns;
-    Objectinfo	*oldobjectinfotable;
-    int		idx, regexselectflag = 1;
-
-    /* extract the object name after the last '/' char */
-    if (((chptr=strrchr(pathname, PATHDELIMITERCHAR)) != NULL) && *(chptr+1) != '\0'){
-	strcpy(objectname, chptr+1);
-    } else {
-	strcpy(objectname, pathname);
-    }
+Set *flagptr (returncode or a warning's flag) to 1 and return its previous value,
+atomically, as several tree traversal threads (-j) may set the same flag at once.
+A warning is then displayed (once) only if the previous value was 0.
+*******************************************************************************/
+int set_shared_flag(int *flagptr) {
+    return __atomic_exchange_n(flagptr, 1, __ATOMIC_RELAXED);
+}
 
-    /* if there is/are any ERE(s), loop through them all. If _all_ entries are either
-     * '-p match' or '-x non-match', this object is selected. If even one entry is a
-     * '-p non-match' or '-x match', this object is skipped. ERE(s) are checked in CLI order.
-    */
-    for (idx=0; idx<numeres; idx++) {	/* this for loop is skipped when numeres is 0 */
-	if (regexec(&eretable[idx].compiledere, objectname, (size_t)0, NULL, 0) != eretable[idx].matchcode) {
-	    regexselectflag = 0;	/* -p non-match or -x match: skip this object */
-	    break;			/* no need to check any later ERE(s) */
-	}
+
+/*******************************************************************************
+Allocate the (empty) object table *tableptr with room for INITMAXNUMOBJS objects.
+Only the columns that every object has are allocated (see Objecttable).
+*******************************************************************************/
+void init_object_table(Objecttable *tableptr) {
+    memset(tableptr, 0, sizeof(Objecttable));
+    tableptr->maxnumobjs = INITMAXNUMOBJS;
+    if ((tableptr->names=(char**)malloc(INITMAXNUMOBJS*sizeof(char *))) == NULL ||
+		(tableptr->typecodes=(unsigned char*)malloc(INITMAXNUMOBJS)) == NULL ||
+		(tableptr->fetchcodes=(unsigned char*)malloc(INITMAXNUMOBJS)) == NULL) {
+	perror("E: Could not malloc initial object table");
+	exit(1);
     }
+}
 
-    if (regexselectflag) {
-	if (lstat(pathname, &statinfo) == -1) {
-	    fprintf(stderr, "W: process_object: Cannot access '%s'\n", pathname);
-	    returncode = 1;
-	    return;
-	}
 
-	if (accesstimeflag) {
-	    objecttime_s = statinfo.st_atime;
-	    objecttime_ns = statinfo.st_atim.tv_nsec;
-	} else {
-	    objecttime_s = statinfo.st_mtime;
-	    objecttime_ns = statinfo.st_mtim.tv_nsec;
-	}
+/*******************************************************************************
+Free the columns of the object table *tableptr (but not the objects' names).
+*******************************************************************************/
+void free_object_table(Objecttable *tableptr) {
+    free(tableptr->names);
+    free(tableptr->times_s);
+    free(tableptr->times_ns);
+    free(tableptr->sizes);
+    free(tableptr->typecodes);
+    free(tableptr->fetchcodes);
+}
 
-	if (
-	    /* If the object's (modification xor access) time is such that it should be selected */
-	    (
-		(targettime_s == DEFAULTAGE && targettime_ns == DEFAULTAGE) ||
-		( newerthantargetflag && (objecttime_s > targettime_s || (objecttime_s == targettime_s && objecttime_ns >= targettime_ns))) ||
-		(!newerthantargetflag && (objecttime_s < targettime_s || (objecttime_s == targettime_s && objecttime_ns <= targettime_ns)))
-	    ) &&
-	    /* AND the object's size is such that it should be selected */
-	    (
-		(selectsizecontrol == SELECTALLSIZES) ||
-		(selectsizecontrol == SELECTLARGERSIZES  && statinfo.st_size >= selectobjectsize) ||
-		(selectsizecontrol == SELECTSMALLERSIZES && statinfo.st_size <= selectobjectsize)
-	    ) &&
-	    /* AND the object is owned by a user to be selected */
-	    (
-		((int)selectuid == SELECTALLUSERS || selectuid == statinfo.st_uid)
-	    )
-	) {
-	    if (numobjsfound >= maxnumberobjects) {
-		if (maxnumberobjects <= MAXNUMOBJSMLTLIM) {
-		    maxnumberobjects *= MAXNUMOBJSMLTFCT;
-		} else {
-		    maxnumberobjects += MAXNUMOBJSINCVAL;
-		}
-		oldobjectinfotable = objectinfotable;
-		if ((objectinfotable=realloc(objectinfotable, maxnumberobjects*sizeof(Objectinfo))) == NULL) {
-		    perror("E: insufficient memory - realloc failed");
-		    free(oldobjectinfotable);		/* Only here to make Cppcheck happy */
-		    exit(1);
-		}
-	    }
 
-	    if ((objectinfotable[numobjsfound].name=malloc(strlen(pathname)+1)) == NULL) {
-		perror("E: insufficient memory - malloc failed");
-		exit(1);
-	    }
-	    strcpy(objectinfotable[numobjsfound].name, pathname);
-	    objectinfotable[numobjsfound].size = statinfo.st_size;
-	    objectinfotable[numobjsfound].type = statinfo.st_mode;
-	    objectinfotable[numobjsfound].uid  = statinfo.st_uid;
-	    objectinfotable[numobjsfound].time_s = objecttime_s;
-	    objectinfotable[numobjsfound].time_ns = objecttime_ns;
-	    numobjsfound++;
-	}
+/*******************************************************************************
+(Re)allocate an object table column (*columnptr) for maxnumobjs objects of
+elementsize bytes each.
+*******************************************************************************/
+void resize_object_column(void **columnptr, size_t elementsize, int maxnumobjs) {
+    void	*oldcolumn = *columnptr;
+
+    if ((*columnptr=realloc(*columnptr, maxnumobjs*elementsize)) == NULL) {
+	perror("E: insufficient memory - realloc failed");
+	free(oldcolumn);		/* Only here to make Cppcheck happy */
+	exit(1);
     }
 }
 
 
 /*******************************************************************************
-Strip any trailing '/' character(s) from pathname. This function is called when
-processing a directory or a symbolic link to a directory at recursion level 0
-(so, specified on the command line). It seems that many *NIX commands process
-'dirsymlink' and 'dirsymlink/' differently. When processing symbolic links to
-directories, there are two cases:
-1. When -L is not specified (the default): findfiles reproduces the behavior of
-   find (et al). A command line symbolic link target WITH a trailing slash ('/')
-   (eg, 'dirsymlink/') is followed, but when such a target has no trailing
-   slash (eg, 'dirsymlink') the symbolic link is NOT followed.
-2. When -L is specified: findfiles always follows all symbolic links.
-In the words of one of my old project managers at the Cupertino HP UNIX lab in
-1987, "standard is better than better". I still don't like it, though.
+Return the 8 bit type code (the typecodemodetable index) of the S_IF... type.
 *******************************************************************************/
-void trim_trailing_slashes(char *pathname) {
-    char	*chptr;
-    int		len;
+unsigned char get_type_code(mode_t type) {
+    unsigned char	typecode;
 
-    len = strlen(pathname);
-    if (len > 1) {		/* handle the special case of '/' correctly */
-	chptr = pathname+len-1;
-	while (chptr >= pathname && *chptr == PATHDELIMITERCHAR) {
-	    *chptr-- = '\0';
-	}
+    for (typecode=0; typecode<NUMTYPECODES-1 && (type & S_IFMT) != typecodemodetable[typecode]; typecode++) {
+	;
     }
+    return typecode;
 }
 
 
 /*******************************************************************************
-Very large numbers can be difficult to read - especially when they have no
-thousands separators. This function displays object sizes with a suitably scaled
-decimal part (a "mantissa" of sorts) and a suitable unit (eg, "GiB").  For
-example, an object of size 1000000000B is displayed as "1.00MB" or "954MiB".
+Set the columns of object idx in the object table *tableptr to name and the
+information in *objectinfoptr. The listed time and size are only stored if they
+were fetched (and their columns are allocated when first needed).
 *******************************************************************************/
-#define TENLIMIT	9.9999	/* Prevent printf rounding issues with 10 */
-#define HUNDREDLIMIT	99.999	/* Prevent printf rounding issues with 100 */
-
-void display_human_readable_size(size_t size) {
-    float mantissa;
-    size_t unitidx, divisor = 1;
-
-    /* Loop from index 0 to (max) N-2. That is, max N-1 interations! */
-    for (unitidx=0; unitidx<numhumanunits-1; unitidx++) {
-	if (size < humanunittable[unitidx].sizelimit) {
-	    break;
-	} else {
-	    divisor = humanunittable[unitidx].sizelimit;
+void set_stored_object(Objecttable *tableptr, int idx, const Objectinfo *objectinfoptr, char *name) {
+    int		timeidx = get_time_index(objectinfoptr->timeinfochar);
+
+    tableptr->names[idx] = name;
+    tableptr->typecodes[idx] = get_type_code(objectinfoptr->type);
+    tableptr->fetchcodes[idx] = timeidx;
+    if (objectinfoptr->statmask & timestatmasktable[timeidx]) {
+	if (tableptr->times_s == NULL) {
+	    resize_object_column((void**)&tableptr->times_s, sizeof(time_t), tableptr->maxnumobjs);
+	    resize_object_column((void**)&tableptr->times_ns, sizeof(uint32_t), tableptr->maxnumobjs);
 	}
+	tableptr->times_s[idx] = objectinfoptr->time_s;
+	tableptr->times_ns[idx] = objectinfoptr->time_ns;
+	tableptr->fetchcodes[idx] |= OBJTIMEFETCHED;
     }
-    /* Use the largest unit's details even if the file size exceeds its sizelimit */
-    mantissa = size / (float)divisor;
-
-    if (mantissa < TENLIMIT) {
-	printf(" %4.2f%s  ", mantissa, humanunittable[unitidx].unitstring);
-    } else if (mantissa < HUNDREDLIMIT) {
-	printf(" %4.1f%s  ", mantissa, humanunittable[unitidx].unitstring);
-    } else {
-	printf(" %4.0f%s  ", mantissa, humanunittable[unitidx].unitstring);
+    if (objectinfoptr->statmask & STATX_SIZE) {
+	if (tableptr->sizes == NULL) {
+	    resize_object_column((void**)&tableptr->sizes, sizeof(off_t), tableptr->maxnumobjs);
+	}
+	tableptr->sizes[idx] = objectinfoptr->size;
+	tableptr->fetchcodes[idx] |= OBJSIZEFETCHED;
     }
 }
 
 
 /*******************************************************************************
-Process a (file system) pathname (a file, directory or "other" object).
+Append an object (name & *objectinfoptr) to the object table *tableptr. If the
+table is full, (all the allocated columns of) its size is dynamically increased.
 *******************************************************************************/
-void process_path(char *pathname, int recursiondepth) {
-    struct stat	statinfo;
-
-    if (!regularfileflag && !directoryflag && !otherobjectflag) {
-	fprintf(stderr, "W: Please choose at least one object type (-f, -d or -o) for '%s'!\n", pathname);
-	returncode = 1;
-	return;
-    }
-
-    if (lstat(pathname, &statinfo) == -1) {
-	fprintf(stderr, "W: process_path: Cannot access '%s'\n", pathname);
-	returncode = 1;
-	return;
-    }
-
-    if (S_ISREG(statinfo.st_mode)) {		/* process a "regular" file */
-	if (regularfileflag) {
-	    process_object(pathname);
-	}
-    /* process a directory or symlink to a directory if followsymlinksflag is set */
-    } else if (S_ISDIR(statinfo.st_mode) || (S_ISLNK(statinfo.st_mode) && followsymlinksflag)) {
-	if (recursiondepth == 0) {
-	   trim_trailing_slashes(pathname);
+void store_object(Objecttable *tableptr, const Objectinfo *objectinfoptr, char *name) {
+    if (tableptr->numobjs >= tableptr->maxnumobjs) {
+	if (tableptr->maxnumobjs <= MAXNUMOBJSMLTLIM) {
+	    tableptr->maxnumobjs *= MAXNUMOBJSMLTFCT;
+	} else {
+	    tableptr->maxnumobjs += MAXNUMOBJSINCVAL;
 	}
-	if (directoryflag) {
-	    process_object(pathname);
+	resize_object_column((void**)&tableptr->names, sizeof(char *), tableptr->maxnumobjs);
+	resize_object_column((void**)&tableptr->typecodes, 1, tableptr->maxnumobjs);
+	resize_object_column((void**)&tableptr->fetchcodes, 1, tableptr->maxnumobjs);
+	if (tableptr->times_s != NULL) {
+	    resize_object_column((void**)&tableptr->times_s, sizeof(time_t), tableptr->maxnumobjs);
+	    resize_object_column((void**)&tableptr->times_ns, sizeof(uint32_t), tableptr->maxnumobjs);
 	}
-
-	/* Is this a command line argument (directory or symlink/) AND maxrecursiondepth > 0 */
-	if (recursiondepth == 0 && maxrecursiondepth > 0) {
-	    process_directory(pathname, recursiondepth);
-	} else if (recursiveflag) {
-	    if (recursiondepth < maxrecursiondepth && recursiondepth < filedescriptorsavailable) {
-		process_directory(pathname, recursiondepth);
-	    } else {
-		fprintf(stderr, "W: Cannot traverse directory '%s' (depth %d)\n", pathname, recursiondepth);
-		if (recursiondepth >= maxrecursiondepth) {
-		    fprintf(stderr, "W: Maximum tree traversal depth is %d\n", maxrecursiondepth);
-		}
-		if (recursiondepth >= filedescriptorsavailable) {
-		    fprintf(stderr, "W: (soft) file descriptor limit is %d\n", filedescriptorsavailable);
-		}
-	    }
+	if (tableptr->sizes != NULL) {
+	    resize_object_column((void**)&tableptr->sizes, sizeof(off_t), tableptr->maxnumobjs);
 	}
-    } else if (otherobjectflag) {		/* process "other" object types */
-	process_object(pathname);
     }
+    set_stored_object(tableptr, tableptr->numobjs++, objectinfoptr, name);
 }
 
 
 /*******************************************************************************
-Process a directory. Open it, read all it's entries (objects) and call
-process_path for each one (EXCEPT '.' and '..') and close it.
+Set *objectinfoptr to the information of object idx in the object table *tableptr
+(its name, type, and, if they were fetched, its listed time and size).
 *******************************************************************************/
-void process_directory(char *pathname, int recursiondepth) {
-    DIR			*dirptr;
-    struct dirent	*direntptr;
-    char		newpathname[MAXPATHLENGTH], pathdelimiterstr[2];
-
-    if ((dirptr=opendir(pathname)) == (DIR*)NULL) {
-	fprintf(stderr, "W: opendir error - ");
-	perror(pathname);
-	returncode = 1;
-	return;
+void get_stored_object(const Objecttable *tableptr, int idx, Objectinfo *objectinfoptr) {
+    unsigned char	fetchcode = tableptr->fetchcodes[idx];
+
+    objectinfoptr->name = tableptr->names[idx];
+    objectinfoptr->type = typecodemodetable[tableptr->typecodes[idx]];
+    objectinfoptr->timeinfochar = TIMEINFOCHARS[fetchcode & OBJTIMEINDEXMASK];
+    objectinfoptr->statmask = STATX_TYPE;
+    objectinfoptr->time_s = objectinfoptr->time_ns = DEFAULTAGE;
+    objectinfoptr->size = 0;
+    if (fetchcode & OBJTIMEFETCHED) {
+	objectinfoptr->time_s = tableptr->times_s[idx];
+	objectinfoptr->time_ns = tableptr->times_ns[idx];
+	objectinfoptr->statmask |= timestatmasktable[fetchcode & OBJTIMEINDEXMASK];
     }
-
-    /* Prevent a newpathname starting with "//" when pathname is "/" */
-    if (strcmp(pathname, "/")) {
-	strcpy(pathdelimiterstr, "/");	/* pathname is not "/", set pathdelimiterstr to "/" */
-    } else {
-	strcpy(pathdelimiterstr, "");	/* pathname is "/", set pathdelimiterstr to "" (null string) */
+    if (fetchcode & OBJSIZEFETCHED) {
+	objectinfoptr->size = tableptr->sizes[idx];
+	objectinfoptr->statmask |= STATX_SIZE;
     }
+}
 
-    while ((direntptr=readdir(dirptr)) != (struct dirent *)NULL) {
-	if (strcmp(direntptr->d_name, ".") && strcmp(direntptr->d_name, "..")) {
-	    sprintf(newpathname, "%s%s%s", pathname, pathdelimiterstr, direntptr->d_name);
-	    process_path(newpathname, recursiondepth+1);
-	}
-    }
 
-    if (closedir(dirptr)) {
-	perror(pathname);
-	returncode = 1;
-    }
+/*******************************************************************************
+Return the index (in Objectinfo objecttimes_s/_ns) of the MODTIMEINFOCHAR,
+ACCTIMEINFOCHAR, CHGTIMEINFOCHAR or BIRTHTIMEINFOCHAR time.
+*******************************************************************************/
+int get_time_index(char objecttimeinfochar) {
+    return strchr(TIMEINFOCHARS, objecttimeinfochar) - TIMEINFOCHARS;
 }
 
 
 /*******************************************************************************
-Comparison function for sorting objectinfotable by time (with qsort). The sort
-order is: seconds, then nanoseconds, then filename.
+Set the listed time of *objectinfoptr (time_s & time_ns) to its
+objecttimeinfochar time.
 *******************************************************************************/
-int compare_object_time_info(const void *firstptr, const void *secondptr) {
-    const Objectinfo	*firstobjinfoptr = firstptr;	/* to keep gcc happy */
-    const Objectinfo	*secondobjinfoptr = secondptr;
+void set_listed_time(Objectinfo *objectinfoptr, char objecttimeinfochar) {
+    int		timeidx = get_time_index(objecttimeinfochar);
 
-    if (firstobjinfoptr->time_s != secondobjinfoptr->time_s) {
-	/* if the timestamp seconds value are different, sort by this */
-	return (secondobjinfoptr->time_s - firstobjinfoptr->time_s)*sortmultiplier;
-    } else {	/* if the timestamp seconds timestamp value are the same, check the ns */
-	if (firstobjinfoptr->time_ns != secondobjinfoptr->time_ns) {
-	    /* the timestamps ns values are different, sort by these */
-	    return (secondobjinfoptr->time_ns - firstobjinfoptr->time_ns)*sortmultiplier;
-	} else {
-	    /* the timestamps are the same (both s and ns), sort by name */
-	    return (strcoll(firstobjinfoptr->name, secondobjinfoptr->name))*sortmultiplier;
-	}
-    }
+    objectinfoptr->time_s = objectinfoptr->objecttimes_s[timeidx];
+    objectinfoptr->time_ns = objectinfoptr->objecttimes_ns[timeidx];
+    objectinfoptr->timeinfochar = objecttimeinfochar;
 }
 
+
 /*******************************************************************************
-Comparison function for sorting objectinfotable by size (with qsort). The sort
-order is: size, then filename.
+Return the mask of the STATX_... fields that the selection (time, size or owner)
+and the output (verbose, sort by time or size) need. The object's type is always
+needed, and is all that's needed to list objects by name.
 *******************************************************************************/
-int compare_object_size_info(const void *firstptr, const void *secondptr) {
-    const Objectinfo	*firstobjinfoptr = firstptr;	/* to keep gcc happy */
-    const Objectinfo	*secondobjinfoptr = secondptr;
+unsigned get_stat_mask(char objecttimeinfochar) {
+    unsigned	statmask = STATX_TYPE;
+    int		idx;
 
-    /* return (firstobjinfoptr->size-secondobjinfoptr->size)*sortmultiplier; cannot handle large object sizes! */
-    if (firstobjinfoptr->size > secondobjinfoptr->size) {
-	return sortmultiplier;
-    } else if (firstobjinfoptr->size < secondobjinfoptr->size) {
-	return -sortmultiplier;
-    } else {	/* If the sizes are the same size, sort by name */
-	return (strcoll(firstobjinfoptr->name, secondobjinfoptr->name))*sortmultiplier;
+    for (idx=0; idx<numselectpredicates; idx++) {
+	if (selectpredicatetable[idx].kind == PREDTIME) {
+	    statmask |= timestatmasktable[selectpredicatetable[idx].timeidx];
+	} else {
+	    statmask |= selectpredicatetable[idx].kind == PREDSIZE ? STATX_SIZE : STATX_UID;
+	}
+    }
+    if (verbosity > 0 || (!nosortflag && compare_object_function_ptr == &compare_object_time_info)) {
+	statmask |= timestatmasktable[get_time_index(objecttimeinfochar)];
     }
+    if (verbosity > 0 || (!nosortflag && compare_object_function_ptr == &compare_object_size_info)) {
+	statmask |= STATX_SIZE;
+    }
+    if (uniqueflag) {
+	statmask |= STATX_INO;
+    }
+    return statmask;
 }
 
 
 /*******************************************************************************
-Comparison function for sorting objectinfotable by object name (with qsort).
+Decide which fields of the selected objects have to be fetched, if any. Objects
+are classified as files, directories or "other" using the directory entry type
+(d_type) where the file system provides it, so when only the type is needed,
+objects are not stat'ed at all. When they are, each object is stat'ed once, and
+(with statx) only the fields needed are requested.
 *******************************************************************************/
-int compare_object_name_info(const void *firstptr, const void *secondptr) {
-    const Objectinfo	*firstobjinfoptr = firstptr;	/* to keep gcc happy */
-    const Objectinfo	*secondobjinfoptr = secondptr;
-
-    return (strcoll(firstobjinfoptr->name, secondobjinfoptr->name))*sortmultiplier;
+void plan_object_stats() {
+    objectstatmask = get_stat_mask(timeinfochar);
+    compile_predicate_program();
 }
 
 
+#if HAVESTATX
 /*******************************************************************************
-Sort objectinfotable by time, and display the object's information - optionally,
-the timestamp and age, and (always) the name.  Due to storing times in two
-variables (*_s and *_ns), it is necessary to add 1s to the objectage_ns value and
-subtract 1s from the objectage_s value whenever starttime_ns < the_object's_age_in_ns.
+Copy the statmask fields of *statxinfoptr (as returned by statx) to
+*objectinfoptr. Its time_s & time_ns are set to the objecttimeinfochar time.
 *******************************************************************************/
-void list_objects() {
-    struct tm	*localtimeinfoptr;
-    char	objectagestr[MAXOBJAGESTRLEN], *chptr;
-    int		foundidx, negativeageflag;
-    time_t	objectage_s, objectage_ns, absobjectage_s, days, hrs, mins, secs;
-
-    qsort((void*)objectinfotable, (size_t)numobjsfound, (size_t)sizeof(Objectinfo), compare_object_function_ptr);
-    for (foundidx=0; foundidx<numobjsfound; foundidx++) {
-	if (verbosity > 0) {
-	    if (verbosity > 2) {		/* Test/debug: object time in s and ns */
-		printf("%10ld.%09ld = ", objectinfotable[foundidx].time_s,
-		    objectinfotable[foundidx].time_ns);
-	    }
+void convert_statx_info(const struct statx *statxinfoptr, unsigned statmask, char objecttimeinfochar, Objectinfo *objectinfoptr) {
+    objectinfoptr->type = statxinfoptr->stx_mode;
+    objectinfoptr->size = statxinfoptr->stx_size;
+    objectinfoptr->uid  = statxinfoptr->stx_uid;
+    objectinfoptr->device = makedev(statxinfoptr->stx_dev_major, statxinfoptr->stx_dev_minor);
+    objectinfoptr->inode = statxinfoptr->stx_ino;
+    objectinfoptr->objecttimes_s[0] = statxinfoptr->stx_mtime.tv_sec;	/* see TIMEINFOCHARS */
+    objectinfoptr->objecttimes_ns[0] = statxinfoptr->stx_mtime.tv_nsec;
+    objectinfoptr->objecttimes_s[1] = statxinfoptr->stx_atime.tv_sec;
+    objectinfoptr->objecttimes_ns[1] = statxinfoptr->stx_atime.tv_nsec;
+    objectinfoptr->objecttimes_s[2] = statxinfoptr->stx_ctime.tv_sec;
+    objectinfoptr->objecttimes_ns[2] = statxinfoptr->stx_ctime.tv_nsec;
+    if ((statmask & STATX_BTIME) && !(statxinfoptr->stx_mask & STATX_BTIME) && !set_shared_flag(&birthtimewarningflag)) {
+	fprintf(stderr, "W: Birth times are not available on (some of) the file systems searched (using 0)\n");
+    }
+    objectinfoptr->objecttimes_s[3] = statxinfoptr->stx_mask & STATX_BTIME ? statxinfoptr->stx_btime.tv_sec : DEFAULTAGE;
+    objectinfoptr->objecttimes_ns[3] = statxinfoptr->stx_mask & STATX_BTIME ? statxinfoptr->stx_btime.tv_nsec : DEFAULTAGE;
+    objectinfoptr->statmask = statmask;
+    set_listed_time(objectinfoptr, objecttimeinfochar);
+}
+#endif
 
-	    /* year, month day, hour, minute, second */
-	    localtimeinfoptr = localtime(&objectinfotable[foundidx].time_s);
-	    printf(datetimeformatstr, localtimeinfoptr->tm_year+TMBASEYEAR,
-		localtimeinfoptr->tm_mon+TMBASEMONTH, localtimeinfoptr->tm_mday,
-		localtimeinfoptr->tm_hour, localtimeinfoptr->tm_min, localtimeinfoptr->tm_sec);
-	    if (displaynsecflag) {		/* ns */
-		printf(".%09ld", objectinfotable[foundidx].time_ns);
-	    }
 
-	    if (starttime_s > objectinfotable[foundidx].time_s || /* starttime >= object's time */
-					(starttime_s == objectinfotable[foundidx].time_s &&
-					starttime_ns >= objectinfotable[foundidx].time_ns)) {
-		objectage_s = starttime_s - objectinfotable[foundidx].time_s;
-		if (starttime_ns >= objectinfotable[foundidx].time_ns) {
-		    objectage_ns = starttime_ns - objectinfotable[foundidx].time_ns;
-		} else {
-		    objectage_ns = starttime_ns - objectinfotable[foundidx].time_ns + NANOSECONDSPERSECOND;
-		    objectage_s--;
-		}
-		negativeageflag = 0;
-	    } else {					/* object's time is after starttime - future! */
-		objectage_s = starttime_s - objectinfotable[foundidx].time_s;
-		if (starttime_ns <= objectinfotable[foundidx].time_ns) {
-		    objectage_ns = objectinfotable[foundidx].time_ns - starttime_ns;
-		} else {
-		    objectage_ns = objectinfotable[foundidx].time_ns - starttime_ns + NANOSECONDSPERSECOND;
-		    objectage_s++;
-		}
-		negativeageflag = 1;
-	    }
+/*******************************************************************************
+Fetch the statmask fields of object name (in the open directory dirfiledes) into
+*objectinfoptr (all its times). Its time_s & time_ns are set to the
+objecttimeinfochar time (the last modification, access, status change or birth
+time), without triggering an automount (as stat doesn't). Return -1 if it cannot
+be accessed.
+*******************************************************************************/
+int stat_object(int dirfiledes, const char *name, unsigned statmask, char objecttimeinfochar, Objectinfo *objectinfoptr) {
+#if HAVESTATX
+    struct statx	statxinfo;
 
-	    if (verbosity > 2) {		/* Test/debug: object age in s and ns */
-		printf(" %10ld.%09ld = ", objectage_s, objectage_ns);
-	    }
+    if (statx(dirfiledes, name, AT_SYMLINK_NOFOLLOW|AT_NO_AUTOMOUNT|(nosyncflag ? AT_STATX_DONT_SYNC : AT_STATX_SYNC_AS_STAT),
+								statmask, &statxinfo) == -1) {
+	return -1;
+    }
+    convert_statx_info(&statxinfo, statmask, objecttimeinfochar, objectinfoptr);
+#else
+    struct stat		statinfo;
 
-	    if (displaysecondsflag) {	/* object age in seconds */
-		printf("%16ld", objectage_s);
-		if (displaynsecflag) {
-		    printf(".%09ld", objectage_ns);
-		}
-		printf("%c ", secondsunitchar);
-	    } else {				/* object age in days, hours, minutes and seconds */
-		absobjectage_s = objectage_s >= 0 ? objectage_s : -objectage_s;	/* absolute value */
-		days = absobjectage_s/SECONDSPERDAY;
-		hrs = absobjectage_s/SECONDSPERHOUR - days*HOURSPERDAY;
-		mins = absobjectage_s/SECONDSPERMINUTE - days*MINUTESPERDAY - hrs*MINUTESPERHOUR;
-		secs = absobjectage_s % SECONDSPERMINUTE;
-		sprintf(objectagestr, ageformatstr, days, hrs, mins, secs);
-		/* if objectage_s is negative (future timestamp), display a - sign */
-		if (negativeageflag) {
-		    if ((chptr=strrchr(objectagestr, ' ')) != NULL) {
-			*chptr = NEGATIVESIGNCHAR; /* %07ld : OK for 999999 days - until the year 4707 */
-		    } else {
-			fprintf(stderr, "E: Insufficient 'days' field width in '%s'\n", ageformatstr);
-			exit(1);
-		    }
-		}
-		printf("%s", objectagestr);
+    if (fstatat(dirfiledes, name, &statinfo, AT_SYMLINK_NOFOLLOW) == -1) {
+	return -1;
+    }
+    objectinfoptr->type = statinfo.st_mode;
+    objectinfoptr->size = statinfo.st_size;
+    objectinfoptr->uid  = statinfo.st_uid;
+    objectinfoptr->device = statinfo.st_dev;
+    objectinfoptr->inode = statinfo.st_ino;
+    objectinfoptr->objecttimes_s[0] = statinfo.st_mtime;	/* see TIMEINFOCHARS */
+    objectinfoptr->objecttimes_ns[0] = statinfo.st_mtim.tv_nsec;
+    objectinfoptr->objecttimes_s[1] = statinfo.st_atime;
+    objectinfoptr->objecttimes_ns[1] = statinfo.st_atim.tv_nsec;
+    objectinfoptr->objecttimes_s[2] = statinfo.st_ctime;
+    objectinfoptr->objecttimes_ns[2] = statinfo.st_ctim.tv_nsec;
+    objectinfoptr->objecttimes_s[3] = objectinfoptr->objecttimes_ns[3] = DEFAULTAGE;
+    objectinfoptr->statmask = statmask;
+    set_listed_time(objectinfoptr, objecttimeinfochar);
+#endif
+    return 0;
+}
 
-		if (displaynsecflag) {
-		    printf(".%09ld", objectage_ns);
-		}
-		printf(" ");
-	    }
 
-	    if (humanunittable == NULL) {
-		printf(" %14lu%c  ", objectinfotable[foundidx].size, bytesunitchar);
-	    } else {
-		display_human_readable_size(objectinfotable[foundidx].size);
-	    }
-	}
+/*******************************************************************************
+Build the pathname of object name in directory dirpathname in pathnamebuf and
+return pathnamebuf. dirpathname is NULL for command line targets (whose name is
+already a pathname). This prevents a pathname starting with "//" when
+dirpathname is "/".
+*******************************************************************************/
+char *build_pathname(char *pathnamebuf, const char *dirpathname, const char *name) {
+    size_t	dirpathnamelen;
 
-	if (displaytypesflag) {		/* In order of expected frequencey (first 3, anyway) */
-	    if      (S_ISREG( objectinfotable[foundidx].type)) printf("Fil ");
-	    else if (S_ISDIR( objectinfotable[foundidx].type)) printf("Dir ");
-	    else if (S_ISLNK( objectinfotable[foundidx].type)) printf("Sln ");
-	    else if (S_ISBLK( objectinfotable[foundidx].type)) printf("Blk ");
-	    else if (S_ISCHR( objectinfotable[foundidx].type)) printf("Chr ");
-	    else if (S_ISFIFO(objectinfotable[foundidx].type)) printf("FIF ");
-	    else if (S_ISSOCK(objectinfotable[foundidx].type)) printf("Soc ");
-	    else 					       printf("Oth ");
+    if (dirpathname == NULL) {
+	strcpy(pathnamebuf, name);
+    } else {
+	dirpathnamelen = strlen(dirpathname);
+	memcpy(pathnamebuf, dirpathname, dirpathnamelen);
+	if (dirpathnamelen != 1 || *dirpathname != PATHDELIMITERCHAR) {
+	    pathnamebuf[dirpathnamelen++] = PATHDELIMITERCHAR;
 	}
-	printf("%s\n", objectinfotable[foundidx].name);
+	strcpy(pathnamebuf+dirpathnamelen, name);
     }
+    return pathnamebuf;
 }
 
 
 /*******************************************************************************
-Integer values must be used with units 'M' (months) and 'Y' (years) because
-months and years vary in size. E.g., '0.5M' does NOT always equate to the same
-amount of time, but 1.33s, 0.25h, 0.5m, 0.1W, etc., all do.
+Return space for a name of namelength bytes (including the terminating null)
+from *arenaptr. When the current block is too full, start a new one - the rest
+of the old one is wasted, but at most one pathname's worth.
 *******************************************************************************/
-void check_integer(char *relativeagestr) {
-    char	*chptr;
+char *allocate_name(Namearena *arenaptr, size_t namelength) {
+    char	*nameptr;
 
-    for (chptr=relativeagestr; chptr<relativeagestr+strlen(relativeagestr)-1; chptr++) {
-	if (!isdigit(*chptr) && *chptr != NEGATIVESIGNCHAR && *chptr != POSITIVESIGNCHAR) {
-	    fprintf(stderr, "E: non-integer character '%c' in '%s'!\n", *chptr, relativeagestr);
-	    exit(-1);
+    if (namelength > arenaptr->numbytesleft) {
+	arenaptr->numbytesleft = namelength > NAMEARENASIZE ? namelength : NAMEARENASIZE;
+	if ((arenaptr->nextnameptr=malloc(arenaptr->numbytesleft)) == NULL) {
+	    perror("E: insufficient memory - malloc failed");
+	    exit(1);
 	}
     }
+    nameptr = arenaptr->nextnameptr;
+    arenaptr->nextnameptr += namelength;
+    arenaptr->numbytesleft -= namelength;
+    return nameptr;
 }
 
 
 /*******************************************************************************
-Convert a (hopefully numeric) string to the equivalent number of nanoseconds (ns).
-Eg "123" to 123000000, "000123" to 123000 and "000000123" to 123.
+Return (malloc'ed) space for an object name of namelength bytes when the object
+table is a -l/--limit heap. These names are freed when their objects are dropped,
+so they are not allocated from an arena.
+*******************************************************************************/
+char *allocate_limited_name(size_t namelength) {
+    char	*nameptr;
+
+    if ((nameptr=malloc(namelength)) == NULL) {
+	perror("E: insufficient memory - malloc failed");
+	exit(1);
+    }
+    return nameptr;
+}
+
+
+/*******************************************************************************
+Swap objects firstidx & secondidx (all their allocated columns) in the object
+table *tableptr.
+*******************************************************************************/
+void swap_stored_objects(Objecttable *tableptr, int firstidx, int secondidx) {
+    char		*name;
+    time_t		time_s;
+    uint32_t		time_ns;
+    off_t		size;
+    unsigned char	code;
+
+    name = tableptr->names[firstidx];
+    tableptr->names[firstidx] = tableptr->names[secondidx];
+    tableptr->names[secondidx] = name;
+    code = tableptr->typecodes[firstidx];
+    tableptr->typecodes[firstidx] = tableptr->typecodes[secondidx];
+    tableptr->typecodes[secondidx] = code;
+    code = tableptr->fetchcodes[firstidx];
+    tableptr->fetchcodes[firstidx] = tableptr->fetchcodes[secondidx];
+    tableptr->fetchcodes[secondidx] = code;
+    if (tableptr->times_s != NULL) {
+	time_s = tableptr->times_s[firstidx];
+	tableptr->times_s[firstidx] = tableptr->times_s[secondidx];
+	tableptr->times_s[secondidx] = time_s;
+	time_ns = tableptr->times_ns[firstidx];
+	tableptr->times_ns[firstidx] = tableptr->times_ns[secondidx];
+	tableptr->times_ns[secondidx] = time_ns;
+    }
+    if (tableptr->sizes != NULL) {
+	size = tableptr->sizes[firstidx];
+	tableptr->sizes[firstidx] = tableptr->sizes[secondidx];
+	tableptr->sizes[secondidx] = size;
+    }
+}
+
+
+/*******************************************************************************
+Compare objects firstidx & secondidx of the object table *tableptr in the order
+they are listed (by compare_object_function_ptr, honoring -R) - using their sort
+keys (see get_sort_key), so only the sort column and the names are touched.
+*******************************************************************************/
+int compare_stored_objects(const Objecttable *tableptr, int firstidx, int secondidx) {
+    Sortkey	firstsortkey, secondsortkey;
+
+    get_stored_sort_key(tableptr, firstidx, &firstsortkey);
+    get_stored_sort_key(tableptr, secondidx, &secondsortkey);
+    return compare_sort_keys(&firstsortkey, tableptr->names[firstidx], &secondsortkey, tableptr->names[secondidx]) *
+											sortmultiplier;
+}
+
+
+/*******************************************************************************
+Compare the (not yet stored) object *objectinfoptr with object idx of the object
+table *tableptr, as compare_stored_objects does.
+*******************************************************************************/
+int compare_object_with_stored(const Objectinfo *objectinfoptr, const Objecttable *tableptr, int idx) {
+    Sortkey	sortkey, storedsortkey;
+
+    get_sort_key(objectinfoptr, &sortkey);
+    get_stored_sort_key(tableptr, idx, &storedsortkey);
+    return compare_sort_keys(&sortkey, objectinfoptr->name, &storedsortkey, tableptr->names[idx])*sortmultiplier;
+}
+
+
+/*******************************************************************************
+Restore the -l/--limit heap order of the object table *tableptr after its object
+idx was appended: move it towards the root (object 0) while it sorts after its
+parent. The root is the object that is listed last (honoring -R).
+*******************************************************************************/
+void sift_object_up(Objecttable *tableptr, int idx) {
+    int		parentidx;
+
+    while (idx > 0 && compare_stored_objects(tableptr, idx, parentidx=(idx-1)/2) > 0) {
+	swap_stored_objects(tableptr, idx, parentidx);
+	idx = parentidx;
+    }
+}
+
+
+/*******************************************************************************
+Restore the -l/--limit heap order of the object table *tableptr after its object
+idx was replaced: move it away from the root while a child sorts after it.
+*******************************************************************************/
+void sift_object_down(Objecttable *tableptr, int idx) {
+    int		childidx;
+
+    while ((childidx=2*idx+1) < tableptr->numobjs) {
+	if (childidx+1 < tableptr->numobjs && compare_stored_objects(tableptr, childidx+1, childidx) > 0) {
+	    childidx++;
+	}
+	if (compare_stored_objects(tableptr, childidx, idx) <= 0) {
+	    break;
+	}
+	swap_stored_objects(tableptr, idx, childidx);
+	idx = childidx;
+    }
+}
+
+
+/*******************************************************************************
+Add *objectinfoptr (whose name was allocated with allocate_limited_name) to the
+-l/--limit heap *tableptr. When the heap is full, whichever of the new object and
+the heap's last object (in sort order) sorts later is dropped and its name freed.
+*******************************************************************************/
+void keep_limited_object(Objecttable *tableptr, const Objectinfo *objectinfoptr) {
+    if (tableptr->numobjs < objectlimit) {
+	store_object(tableptr, objectinfoptr, objectinfoptr->name);
+	sift_object_up(tableptr, tableptr->numobjs-1);
+    } else {
+	set_shared_flag(&limitprunedflag);
+	if (compare_object_with_stored(objectinfoptr, tableptr, 0) < 0) {
+	    free(tableptr->names[0]);
+	    set_stored_object(tableptr, 0, objectinfoptr, objectinfoptr->name);
+	    sift_object_down(tableptr, 0);
+	} else {
+	    free(objectinfoptr->name);
+	}
+    }
+}
+
+
+/*******************************************************************************
+Fold an ASCII upper case letter to lower case. Only used when the locale's case
+mapping for ASCII characters is the usual one (see set_ere_literal).
+*******************************************************************************/
+#define ASCIITOLOWER(c)	((c) >= 'A' && (c) <= 'Z' ? (c)-'A'+'a' : (c))
+
+
+/*******************************************************************************
+Compare length bytes of str with literal, ignoring ASCII case if icaseflag is set
+(literal is already lower case). Return 1 if they are the same, 0 otherwise.
+*******************************************************************************/
+int compare_ere_literal(const char *str, const char *literal, size_t length, int icaseflag) {
+    size_t	idx;
+
+    if (!icaseflag) {
+	return !memcmp(str, literal, length);
+    }
+    for (idx=0; idx<length; idx++) {
+	if (ASCIITOLOWER(str[idx]) != literal[idx]) {
+	    return 0;
+	}
+    }
+    return 1;
+}
+
+
+/*******************************************************************************
+Return 1 if the ERE's literal occurs in objectname (of namelength bytes) in the
+position required by the ERE's literal kind (anywhere, at the start, at the end
+or as the whole name), 0 otherwise.
+*******************************************************************************/
+int find_ere_literal(const char *objectname, size_t namelength, const Ereinfo *ereptr) {
+    const char	*cptr, *lastptr;
+    size_t	length;
+
+    length = ereptr->literallength;
+    if (namelength < length) {
+	return 0;
+    }
+    switch (ereptr->literalkind) {
+	case ERELITERALPREFIX:
+	    return compare_ere_literal(objectname, ereptr->literal, length, ereptr->icaseflag);
+	case ERELITERALSUFFIX:
+	    return compare_ere_literal(objectname+namelength-length, ereptr->literal, length, ereptr->icaseflag);
+	case ERELITERALEXACT:
+	    return namelength == length && compare_ere_literal(objectname, ereptr->literal, length, ereptr->icaseflag);
+    }
+    if (!ereptr->icaseflag) {				/* ERELITERALFILTER or ERELITERALCONTAINS */
+	return memmem(objectname, namelength, ereptr->literal, length) != NULL;
+    }
+    lastptr = objectname + namelength - length;
+    for (cptr=objectname; cptr<=lastptr; cptr++) {
+	if (ASCIITOLOWER(*cptr) == ereptr->literal[0] && compare_ere_literal(cptr, ereptr->literal, length, 1)) {
+	    return 1;
+	}
+    }
+    return 0;
+}
+
+
+/*******************************************************************************
+Return REG_MATCH if objectname matches any of the numregexes regexes in regextable,
+REG_NOMATCH otherwise.
+*******************************************************************************/
+int match_any_regex(const regex_t *regextable, int numregexes, const char *objectname) {
+    int		idx;
+
+    for (idx=0; idx<numregexes; idx++) {
+	if (regexec(&regextable[idx], objectname, (size_t)0, NULL, 0) == REG_MATCH) {
+	    return REG_MATCH;
+	}
+    }
+    return REG_NOMATCH;
+}
+
+
+/*******************************************************************************
+Return REG_MATCH if objectname (of namelength bytes) matches any of the EREs in the
+set, REG_NOMATCH otherwise. The name is scanned once by the Aho-Corasick automaton
+to find every member's literal. A member that is just its (anchored) literal is
+decided there and then. If no such member matches, but the literal of a member that
+needs regexec was found (or a member has no literal), the merged regex(es) of those
+members decide. Names with non-ASCII bytes that the automaton can't decide (see
+match_object_name) are matched against all the members with regexec.
+*******************************************************************************/
+int match_ere_set(const Ereset *ereset, const char *objectname, size_t namelength, int highbyteflag) {
+    const Acnode	*acnodetable;
+    const Ereinfo	*memberptr;
+    size_t		idx;
+    int			node, dictnode, memberidx, regexneededflag;
+    unsigned char	c;
+
+    if (highbyteflag && (ereset->icaseflag || ereset->multibyteflag)) {
+	return match_any_regex(ereset->allregextable, ereset->numallregexes, objectname);
+    }
+
+    acnodetable = ereset->acnodetable;
+    regexneededflag = ereset->numnoliteralmembers > 0;
+    node = 0;
+    for (idx=0; idx<namelength; idx++) {
+	c = (unsigned char)objectname[idx];
+	if (c >= NUMACCHARS) {
+	    node = 0;				/* no literal contains a non-ASCII byte */
+	    continue;
+	}
+	node = acnodetable[node].next[ereset->icaseflag ? ASCIITOLOWER(c) : c];
+	dictnode = acnodetable[node].memberidx >= 0 ? node : acnodetable[node].dictnode;
+	for ( ; dictnode>=0; dictnode=acnodetable[dictnode].dictnode) {
+	    for (memberidx=acnodetable[dictnode].memberidx; memberidx>=0; memberidx=ereset->nextmembertable[memberidx]) {
+		memberptr = &ereset->membertable[memberidx];
+		switch (memberptr->literalkind) {	/* the literal ends at idx */
+		    case ERELITERALCONTAINS:
+			return REG_MATCH;
+		    case ERELITERALPREFIX:
+			if (idx+1 == memberptr->literallength) {
+			    return REG_MATCH;
+			}
+			break;
+		    case ERELITERALSUFFIX:
+			if (idx+1 == namelength) {
+			    return REG_MATCH;
+			}
+			break;
+		    case ERELITERALEXACT:
+			if (idx+1 == namelength && namelength == memberptr->literallength) {
+			    return REG_MATCH;
+			}
+			break;
+		    default:				/* ERELITERALFILTER */
+			regexneededflag = 1;
+			break;
+		}
+	    }
+	}
+    }
+    return regexneededflag ? match_any_regex(ereset->restregextable, ereset->numrestregexes, objectname) : REG_NOMATCH;
+}
+
+
+/*******************************************************************************
+Match objectname (namelength long, with bytes >= 0x80 if highbyteflag is set)
+against the ERE (or ERE set) *ereptr. Return REG_MATCH or REG_NOMATCH, as regexec.
+*******************************************************************************/
+int match_ere(const Ereinfo *ereptr, const char *objectname, size_t namelength, int highbyteflag) {
+    if (ereptr->ereset != NULL) {
+	return match_ere_set(ereptr->ereset, objectname, namelength, highbyteflag);
+    } else if (ereptr->literalkind == ERELITERALNONE || (highbyteflag && ereptr->icaseflag)) {
+	return regexec(&ereptr->compiledere, objectname, (size_t)0, NULL, 0);
+    } else if (!find_ere_literal(objectname, namelength, ereptr)) {
+	return REG_NOMATCH;	/* the literal is missing: regexec can't match either */
+    } else if (ereptr->literalkind == ERELITERALFILTER || (highbyteflag && ereptr->multibyteflag)) {
+	return regexec(&ereptr->compiledere, objectname, (size_t)0, NULL, 0);
+    } else {
+	return REG_MATCH;	/* the ERE is just the (anchored) literal */
+    }
+}
+
+
+/*******************************************************************************
+If there is/are any ERE(s), loop through them all. If _all_ entries are either
+'-p match' or '-x non-match', this object is selected. If even one entry is a
+'-p non-match' or '-x match', this object is skipped. ERE(s) are checked in CLI
+order. Return 1 if the object (objectname) is selected, 0 otherwise.
+*******************************************************************************/
+int match_object_name(const char *objectname) {
+    const unsigned char	*cptr;
+    size_t		namelength;
+    int			idx, highbyteflag;
+
+    if (numeres == 0) {
+	return 1;
+    }
+
+    highbyteflag = 0;			/* find the name's length & whether it is all ASCII in one pass */
+    for (cptr=(const unsigned char*)objectname; *cptr!='\0'; cptr++) {
+	highbyteflag |= *cptr & 0x80;
+    }
+    namelength = (size_t)(cptr - (const unsigned char*)objectname);
+
+    for (idx=0; idx<numeres; idx++) {
+	if (match_ere(&eretable[idx], objectname, namelength, highbyteflag) != eretable[idx].matchcode) {
+	    return 0;			/* -p non-match or -x match: skip this object */
+	}
+    }
+    return 1;
+}
+
+
+/*******************************************************************************
+-K/--prune: return 1 if the directory name matches any of the prune EREs (so it
+isn't traversed), 0 otherwise.
+*******************************************************************************/
+int prune_directory(const char *name) {
+    const unsigned char	*cptr;
+    int			idx, highbyteflag = 0;
+
+    for (cptr=(const unsigned char*)name; *cptr!='\0'; cptr++) {
+	highbyteflag |= *cptr & 0x80;
+    }
+    for (idx=0; idx<numprunes; idx++) {
+	if (match_ere(&prunetable[idx], name, (size_t)(cptr - (const unsigned char*)name), highbyteflag) == REG_MATCH) {
+	    return 1;
+	}
+    }
+    return 0;
+}
+
+
+/*******************************************************************************
+Process a (file system) object - eg, a regular file, directory, symbolic
+link, fifo, special file, etc. If the object's attributes satisfy the command
+line arguments (i.e., the name matches the 'pattern(s)' - actually, Extended
+Regular Expression(s) or  ERE(s), the access xor modification time, etc. then,
+this object's columns are appended to objecttable (see store_object), whose
+columns are dynamically enlarged. When called by a tree traversal thread (workerptr
+is not NULL), the object is appended to that thread's own object table instead.
+The object is accessed by name relative to the open directory dirfiledes, and its
+full pathname is only built if it is selected. statinfoptr points to the object's
+information if process_path has already stat'ed it (otherwise it's NULL, and type
+is the object's S_IF... type from its directory entry). namematch is the result of
+match_object_name if it has already been called (by entry_needs_stat), otherwise
+NAMEMATCHUNKNOWN. With -l/--limit, the
+object table is a heap of (at most) limit objects: a selected object is only kept
+if it sorts before the heap's last one, which is then dropped (and its name freed).
+With -O/--no-sort, the object is listed immediately instead.
+*******************************************************************************/
+void process_object(int dirfiledes, const char *dirpathname, const char *name, mode_t type,
+					const Objectinfo *statinfoptr, Workerinfo *workerptr, int namematch) {
+    Objectinfo	objectinfo;
+    Objecttable	*tableptr;
+    char	pathname[MAXPATHLENGTH], *storedname;
+    const char	*objectname, *chptr;
+    size_t	namelength;
+
+    /* extract the object name after the last '/' char (only command line targets can contain one) */
+    if (((chptr=strrchr(name, PATHDELIMITERCHAR)) != NULL) && *(chptr+1) != '\0'){
+	objectname = chptr+1;
+    } else {
+	objectname = name;
+    }
+
+    if (namematch == NAMEMATCHUNKNOWN ? match_object_name(objectname) : namematch) {
+	if (statinfoptr != NULL) {
+	    objectinfo = *statinfoptr;
+	} else if (objectstatmask != STATX_TYPE) {
+	    if (stat_object(dirfiledes, name, objectstatmask, timeinfochar, &objectinfo) == -1) {
+		fprintf(stderr, "W: process_object: Cannot access '%s'\n", build_pathname(pathname, dirpathname, name));
+		set_shared_flag(&returncode);
+		return;
+	    }
+	} else {	/* nothing but the name and type are required: no stat */
+	    objectinfo.type = type;
+	    memset(objectinfo.objecttimes_s, DEFAULTAGE, sizeof(objectinfo.objecttimes_s));
+	    memset(objectinfo.objecttimes_ns, DEFAULTAGE, sizeof(objectinfo.objecttimes_ns));
+	    objectinfo.time_s = objectinfo.time_ns = DEFAULTAGE;
+	    objectinfo.size = 0;
+	    objectinfo.uid = 0;
+	    objectinfo.statmask = STATX_TYPE;
+	    objectinfo.timeinfochar = timeinfochar;
+	}
+
+	if (
+	    /* If the object's times, size & owner are such that it should be selected */
+	    numpredicateops == 0 || run_predicate_program(&objectinfo)
+	) {
+	    /* -Z: directories (and with -L, what symbolic links point to) were checked by process_path */
+	    if (uniqueflag && !S_ISDIR(type) && !(S_ISLNK(type) && followsymlinksflag) &&
+		    !insert_unique_object(objectinfo.device, objectinfo.inode)) {
+		return;
+	    }
+	    if (nosortflag) {		/* list it now, don't store it */
+		objectinfo.name = build_pathname(pathname, dirpathname, name);
+		list_object_unsorted(&objectinfo);
+		return;
+	    }
+
+	    tableptr = workerptr == NULL ? &objecttable : &workerptr->objecttable;
+	    namelength = (dirpathname == NULL ? 0 : strlen(dirpathname)+1)+strlen(name)+1;
+
+	    if (!limitheapflag) {
+		storedname = allocate_name(workerptr == NULL ? &namearena : &workerptr->namearena, namelength);
+		store_object(tableptr, &objectinfo, build_pathname(storedname, dirpathname, name));
+	    } else {	/* don't even allocate the name of an object that the heap would drop */
+		objectinfo.name = build_pathname(pathname, dirpathname, name);
+		if (tableptr->numobjs < objectlimit || compare_object_with_stored(&objectinfo, tableptr, 0) < 0) {
+		    objectinfo.name = strcpy(allocate_limited_name(namelength), pathname);
+		    keep_limited_object(tableptr, &objectinfo);
+		} else {
+		    set_shared_flag(&limitprunedflag);
+		}
+	    }
+	}
+    }
+}
+
+
+/*******************************************************************************
+Run the predicate program (see compile_predicate_program) on *objectinfoptr.
+Return 1 if it's selected (ie, at least one operation of every group is true),
+else 0.
+*******************************************************************************/
+int run_predicate_program(const Objectinfo *objectinfoptr) {
+    const Predicateop	*opptr;
+    time_t		time_s, time_ns;
+    int			opidx, result;
+
+    for (opidx=0; opidx<numpredicateops; ) {
+	opptr = &predicateprogram[opidx];
+	switch (opptr->opcode) {
+	    case OPUIDEQUAL:
+		result = objectinfoptr->uid == opptr->uid;
+		break;
+	    case OPSIZERANGE:
+		result = objectinfoptr->size >= opptr->lowsize && objectinfoptr->size <= opptr->highsize;
+		break;
+	    default:	/* OPTIMERANGE */
+		time_s = objectinfoptr->objecttimes_s[opptr->timeidx];
+		time_ns = objectinfoptr->objecttimes_ns[opptr->timeidx];
+		result = (time_s > opptr->lowtime_s || (time_s == opptr->lowtime_s && time_ns >= opptr->lowtime_ns)) &&
+			 (time_s < opptr->hightime_s || (time_s == opptr->hightime_s && time_ns <= opptr->hightime_ns));
+		break;
+	}
+	if (result != opptr->negateflag) {
+	    opidx = opptr->nextgroupidx;
+	} else if (opptr->lastingroupflag) {
+	    return 0;
+	} else {
+	    opidx++;
+	}
+    }
+    return 1;
+}
+
+
+/*******************************************************************************
+Global flags (eg, -v or -S) can be specified after the targets, so objects that
+were selected without fetching all their information (see plan_object_stats) may
+need more of it after all. If so, stat them again now - by their full pathnames.
+*******************************************************************************/
+void stat_pending_objects() {
+    Objectinfo	storedinfo, objectinfo;
+    unsigned	statmask;
+    int		idx;
+
+    for (idx=0; idx<objecttable.numobjs; idx++) {
+	get_stored_object(&objecttable, idx, &storedinfo);
+	statmask = get_stat_mask(storedinfo.timeinfochar);
+	if (statmask & ~storedinfo.statmask) {
+	    if (stat_object(AT_FDCWD, storedinfo.name, statmask|storedinfo.statmask, storedinfo.timeinfochar, &objectinfo) == -1) {
+		fprintf(stderr, "W: stat_pending_objects: Cannot access '%s'\n", storedinfo.name);
+		returncode = 1;
+		storedinfo.statmask |= statmask;	/* (listed with the defaults) */
+		set_stored_object(&objecttable, idx, &storedinfo, storedinfo.name);
+	    } else {
+		set_stored_object(&objecttable, idx, &objectinfo, storedinfo.name);
+	    }
+	}
+    }
+}
+
+
+/*******************************************************************************
+Fetch all the information about object name (in the open directory dirfiledes)
+that an index file holds into *entryptr. Return -1 if it cannot be accessed.
+*******************************************************************************/
+int stat_index_entry(int dirfiledes, const char *name, Indexentry *entryptr) {
+#if HAVESTATX
+    struct statx	statxinfo;
+
+    if (statx(dirfiledes, name, AT_SYMLINK_NOFOLLOW|(nosyncflag ? AT_STATX_DONT_SYNC : AT_STATX_SYNC_AS_STAT),
+						STATX_BASIC_STATS|STATX_BTIME, &statxinfo) == -1) {
+	return -1;
+    }
+    entryptr->type = statxinfo.stx_mode;
+    entryptr->size = statxinfo.stx_size;
+    entryptr->uid  = statxinfo.stx_uid;
+    entryptr->atime_s = statxinfo.stx_atime.tv_sec;
+    entryptr->atime_ns = statxinfo.stx_atime.tv_nsec;
+    entryptr->mtime_s = statxinfo.stx_mtime.tv_sec;
+    entryptr->mtime_ns = statxinfo.stx_mtime.tv_nsec;
+    entryptr->ctime_s = statxinfo.stx_ctime.tv_sec;
+    entryptr->ctime_ns = statxinfo.stx_ctime.tv_nsec;
+    entryptr->btime_s = statxinfo.stx_mask & STATX_BTIME ? statxinfo.stx_btime.tv_sec : DEFAULTAGE;
+    entryptr->btime_ns = statxinfo.stx_mask & STATX_BTIME ? statxinfo.stx_btime.tv_nsec : DEFAULTAGE;
+    entryptr->statmask = STATX_BASIC_STATS | (statxinfo.stx_mask & STATX_BTIME);
+#else
+    struct stat		statinfo;
+
+    if (fstatat(dirfiledes, name, &statinfo, AT_SYMLINK_NOFOLLOW) == -1) {
+	return -1;
+    }
+    entryptr->type = statinfo.st_mode;
+    entryptr->size = statinfo.st_size;
+    entryptr->uid  = statinfo.st_uid;
+    entryptr->atime_s = statinfo.st_atime;
+    entryptr->atime_ns = statinfo.st_atim.tv_nsec;
+    entryptr->mtime_s = statinfo.st_mtime;
+    entryptr->mtime_ns = statinfo.st_mtim.tv_nsec;
+    entryptr->ctime_s = statinfo.st_ctime;
+    entryptr->ctime_ns = statinfo.st_ctim.tv_nsec;
+    entryptr->btime_s = entryptr->btime_ns = DEFAULTAGE;
+    entryptr->statmask = STATX_BASIC_STATS;
+#endif
+    return 0;
+}
+
+
+/*******************************************************************************
+Copy the information of an index file entry to *objectinfoptr, as stat_object
+would have. Its time_s & time_ns are set to the timeinfochar time.
+*******************************************************************************/
+void convert_index_entry(const Indexentry *entryptr, Objectinfo *objectinfoptr) {
+    objectinfoptr->type = entryptr->type;
+    objectinfoptr->size = entryptr->size;
+    objectinfoptr->uid  = entryptr->uid;
+    objectinfoptr->objecttimes_s[0] = entryptr->mtime_s;	/* see TIMEINFOCHARS */
+    objectinfoptr->objecttimes_ns[0] = entryptr->mtime_ns;
+    objectinfoptr->objecttimes_s[1] = entryptr->atime_s;
+    objectinfoptr->objecttimes_ns[1] = entryptr->atime_ns;
+    objectinfoptr->objecttimes_s[2] = entryptr->ctime_s;
+    objectinfoptr->objecttimes_ns[2] = entryptr->ctime_ns;
+    if ((objectstatmask & STATX_BTIME) && !(entryptr->statmask & STATX_BTIME) && !set_shared_flag(&birthtimewarningflag)) {
+	fprintf(stderr, "W: Birth times are not available on (some of) the file systems searched (using 0)\n");
+    }
+    objectinfoptr->objecttimes_s[3] = entryptr->btime_s;
+    objectinfoptr->objecttimes_ns[3] = entryptr->btime_ns;
+    objectinfoptr->statmask = STATX_BASIC_STATS|STATX_BTIME;	/* all there is */
+    set_listed_time(objectinfoptr, timeinfochar);
+}
+
+
+/*******************************************************************************
+Return the hash (FNV-1a) of the string str.
+*******************************************************************************/
+size_t hash_string(const char *str) {
+    size_t	hash = 2166136261U;
+
+    for ( ; *str!='\0'; str++) {
+	hash = (hash ^ (unsigned char)*str) * 16777619U;
+    }
+    return hash;
+}
+
+
+/*******************************************************************************
+Return the previous index's directory with pathname relpath (relative to the
+target), or NULL if it has none.
+*******************************************************************************/
+const Indexdirectory *find_index_directory(const char *relpath) {
+    const Indexdirectory	*dirptr;
+    size_t			hashidx;
+
+    if (indexhashsize == 0) {
+	return NULL;
+    }
+    for (hashidx=hash_string(relpath) & (indexhashsize-1); (dirptr=indexhashtable[hashidx]) != NULL;
+						hashidx=(hashidx+1) & (indexhashsize-1)) {
+	if (!strcmp((const char*)(dirptr+1), relpath)) {
+	    return dirptr;
+	}
+    }
+    return NULL;
+}
+
+
+/*******************************************************************************
+Read the index file indexfilename of target targetpathname (if there is one) into
+indexbuffer, and hash its directories by their relative pathnames. If the file is
+not a valid index of this target, a warning is displayed and it's ignored (so the
+index is rebuilt from scratch).
+*******************************************************************************/
+void load_index(const char *targetpathname) {
+    FILE			*fileptr;
+    struct stat			statinfo;
+    const Indexheader		*headerptr;
+    const Indexdirectory	*dirptr;
+    const Indexentry		*entryptr;
+    const char			*cptr, *endptr, *entryendptr;
+    size_t			filesize, numdirs, hashidx;
+
+    indexbuffer = NULL;
+    indexhashtable = NULL;
+    indexhashsize = 0;
+    if ((fileptr=fopen(indexfilename, "r")) == NULL) {
+	if (errno != ENOENT) {
+	    fprintf(stderr, "W: Cannot read index file '%s': %s\n", indexfilename, strerror(errno));
+	    returncode = 1;
+	}
+	return;
+    }
+    if (fstat(fileno(fileptr), &statinfo) == -1 || (filesize=statinfo.st_size) < INDEXHEADERSIZE ||
+		(indexbuffer=(char*)malloc(filesize+1)) == NULL || fread(indexbuffer, 1, filesize, fileptr) != filesize) {
+	goto invalidindex;
+    }
+    fclose(fileptr);
+    fileptr = NULL;
+
+    /* check the header & the target, then count the directories */
+    headerptr = (const Indexheader*)indexbuffer;
+    endptr = indexbuffer + filesize;
+    if (memcmp(headerptr->magicstr, INDEXMAGICSTR, sizeof(INDEXMAGICSTR)) || headerptr->entrysize != sizeof(Indexentry) ||
+		headerptr->targetsize > filesize - INDEXHEADERSIZE ||
+		strncmp(indexbuffer+INDEXHEADERSIZE, targetpathname, headerptr->targetsize) ||
+		INDEXALIGN(strlen(targetpathname)+1) != headerptr->targetsize) {
+	goto invalidindex;
+    }
+    numdirs = 0;
+    for (cptr=indexbuffer+INDEXHEADERSIZE+headerptr->targetsize; cptr<endptr; numdirs++) {
+	dirptr = (const Indexdirectory*)cptr;
+	if ((size_t)(endptr-cptr) < sizeof(Indexdirectory) ||
+		dirptr->relpathsize > (size_t)(endptr-cptr) - sizeof(Indexdirectory) ||
+		dirptr->entriessize > (size_t)(endptr-cptr) - sizeof(Indexdirectory) - dirptr->relpathsize ||
+		dirptr->relpathsize == 0 || ((const char*)(dirptr+1))[dirptr->relpathsize-1] != '\0') {
+	    goto invalidindex;
+	}
+	cptr += sizeof(Indexdirectory) + dirptr->relpathsize;
+	for (entryendptr=cptr+dirptr->entriessize; cptr<entryendptr; cptr+=sizeof(Indexentry)+entryptr->namesize) {
+	    entryptr = (const Indexentry*)cptr;
+	    if ((size_t)(entryendptr-cptr) < sizeof(Indexentry) || entryptr->namesize == 0 ||
+			entryptr->namesize > (size_t)(entryendptr-cptr) - sizeof(Indexentry) ||
+			((const char*)(entryptr+1))[entryptr->namesize-1] != '\0') {
+		goto invalidindex;
+	    }
+	}
+    }
+
+    for (indexhashsize=1; indexhashsize<2*numdirs; indexhashsize*=2) {
+	;
+    }
+    if ((indexhashtable=(const Indexdirectory**)calloc(indexhashsize, sizeof(Indexdirectory*))) == NULL) {
+	perror("E: Could not calloc index hash table");
+	exit(1);
+    }
+    for (cptr=indexbuffer+INDEXHEADERSIZE+headerptr->targetsize; cptr<endptr; ) {
+	dirptr = (const Indexdirectory*)cptr;
+	for (hashidx=hash_string((const char*)(dirptr+1)) & (indexhashsize-1); indexhashtable[hashidx] != NULL; ) {
+	    hashidx = (hashidx+1) & (indexhashsize-1);
+	}
+	indexhashtable[hashidx] = dirptr;
+	cptr += sizeof(Indexdirectory) + dirptr->relpathsize + dirptr->entriessize;
+    }
+    return;
+
+invalidindex:
+    fprintf(stderr, "W: '%s' is not a valid index file of '%s', rebuilding it\n", indexfilename, targetpathname);
+    if (fileptr != NULL) {
+	fclose(fileptr);
+    }
+    free(indexbuffer);
+    indexbuffer = NULL;
+    indexhashsize = 0;
+}
+
+
+/*******************************************************************************
+Write size bytes at dataptr, then zeros up to paddedsize bytes, to the new index
+file.
+*******************************************************************************/
+void write_index_data(const void *dataptr, size_t size, size_t paddedsize) {
+    static const char	zerostr[8] = { 0 };
+
+    fwrite(dataptr, 1, size, newindexfileptr);
+    fwrite(zerostr, 1, paddedsize-size, newindexfileptr);
+}
+
+
+/*******************************************************************************
+Read all the entries of the open directory dirfiledes and stat them into a new
+block of index entries. Return the block and set *entriessizeptr to its size, or
+return NULL if the directory cannot be read.
+*******************************************************************************/
+char *read_index_entries(int dirfiledes, const char *pathname, size_t *entriessizeptr) {
+    DIR			*dirptr;
+    struct dirent	*direntptr;
+    Indexentry		*entryptr;
+    char		*entriesbuffer, *oldentriesbuffer;
+    char		objectpathname[MAXPATHLENGTH];
+    size_t		entriessize, maxentriessize, namelength, entrysize;
+    int			dupfiledes;
+
+    entriessize = 0;
+    maxentriessize = 4096;
+    if ((entriesbuffer=(char*)malloc(maxentriessize)) == NULL) {
+	perror("E: insufficient memory - malloc failed");
+	exit(1);
+    }
+    /* readdir on a duplicate, so dirfiledes stays open (for the subdirectories) after closedir */
+    if ((dupfiledes=dup(dirfiledes)) == -1 || (dirptr=fdopendir(dupfiledes)) == (DIR*)NULL) {
+	fprintf(stderr, "W: opendir error - ");
+	perror(pathname);
+	if (dupfiledes != -1) {
+	    close(dupfiledes);
+	}
+	returncode = 1;
+	free(entriesbuffer);
+	*entriessizeptr = 0;
+	return NULL;
+    }
+    while ((direntptr=readdir(dirptr)) != (struct dirent *)NULL) {
+	if (ISDOTORDOTDOT(direntptr->d_name)) {
+	    continue;
+	}
+	namelength = strlen(direntptr->d_name);
+	entrysize = sizeof(Indexentry) + INDEXALIGN(namelength+1);
+	if (entriessize+entrysize > maxentriessize) {
+	    for ( ; entriessize+entrysize > maxentriessize; maxentriessize*=2) {
+		;
+	    }
+	    oldentriesbuffer = entriesbuffer;
+	    if ((entriesbuffer=(char*)realloc(entriesbuffer, maxentriessize)) == NULL) {
+		perror("E: insufficient memory - realloc failed");
+		free(oldentriesbuffer);		/* Only here to make Cppcheck happy */
+		exit(1);
+	    }
+	}
+	entryptr = (Indexentry*)(entriesbuffer+entriessize);
+	if (stat_index_entry(dirfiledes, direntptr->d_name, entryptr) == -1) {
+	    fprintf(stderr, "W: process_path: Cannot access '%s'\n", build_pathname(objectpathname, pathname, direntptr->d_name));
+	    returncode = 1;
+	    continue;
+	}
+	entryptr->namesize = INDEXALIGN(namelength+1);
+	memset((char*)(entryptr+1), 0, entryptr->namesize);
+	memcpy((char*)(entryptr+1), direntptr->d_name, namelength);
+	entriessize += entrysize;
+    }
+    if (closedir(dirptr)) {
+	perror(pathname);
+	returncode = 1;
+    }
+    *entriessizeptr = entriessize;
+    return entriesbuffer;
+}
+
+
+/*******************************************************************************
+Select the object of an index entry (in directory dirpathname), as process_path
+would, if its type is one of those being searched for. namematch is as for
+process_object.
+*******************************************************************************/
+void select_index_entry(const char *dirpathname, const Indexentry *entryptr, int namematch) {
+    Objectinfo	objectinfo;
+
+    if (S_ISREG(entryptr->type) ? regularfileflag : S_ISDIR(entryptr->type) ? directoryflag : otherobjectflag) {
+	convert_index_entry(entryptr, &objectinfo);
+	process_object(AT_FDCWD, dirpathname, (const char*)(entryptr+1), entryptr->type, &objectinfo, NULL, namematch);
+    }
+}
+
+
+/*******************************************************************************
+Display why the directory pathname (at recursiondepth, the maximum) is not
+traversed, as process_path does.
+*******************************************************************************/
+void warn_untraversed_directory(const char *pathname, int recursiondepth) {
+    fprintf(stderr, "W: Cannot traverse directory '%s' (depth %d)\n", pathname, recursiondepth);
+    fprintf(stderr, "W: Maximum tree traversal depth is %d\n", maxrecursiondepth);
+}
+
+
+/*******************************************************************************
+Return 1 if the pathnames of the entries of directory pathname (at
+recursiondepth) fit in MAXPATHLENGTH. If not, it's not traversed: display why,
+and return 0.
+*******************************************************************************/
+int check_pathname_length(const char *pathname, int recursiondepth) {
+    if (strlen(pathname) <= MAXDIRPATHLENGTH) {
+	return 1;
+    }
+    fprintf(stderr, "W: Cannot traverse directory '%s' (depth %d)\n", pathname, recursiondepth);
+    fprintf(stderr, "W: Maximum directory pathname length is %d\n", MAXDIRPATHLENGTH);
+    set_shared_flag(&returncode);
+    return 0;
+}
+
+
+/*******************************************************************************
+Copy the previous index's directory with pathname relpath (relative to the
+target, in a MAXPATHLENGTH buffer) and the subdirectories it lists, recursively,
+to the new index: it's still in the tree, but is not traversed (no -r, -D or
+-K), so it's kept as it was. Directories that are no longer listed are dropped.
+*******************************************************************************/
+void copy_index_subtree(char *relpath) {
+    const Indexdirectory	*dirptr;
+    const Indexentry		*entryptr;
+    const char			*entries;
+    char			*nameptr;
+    size_t			offset, dirsize, relpathlength;
+
+    if ((dirptr=find_index_directory(relpath)) == NULL) {
+	return;
+    }
+    dirsize = sizeof(Indexdirectory) + dirptr->relpathsize + dirptr->entriessize;
+    write_index_data(dirptr, dirsize, dirsize);
+
+    relpathlength = strlen(relpath);
+    entries = (const char*)(dirptr+1) + dirptr->relpathsize;
+    for (offset=0; offset<dirptr->entriessize; offset+=sizeof(Indexentry)+entryptr->namesize) {
+	entryptr = (const Indexentry*)(entries+offset);
+	if (S_ISDIR(entryptr->type) && relpathlength+1+strlen((const char*)(entryptr+1)) < MAXPATHLENGTH) {
+	    nameptr = relpath + relpathlength;
+	    if (relpathlength > 0) {
+		*nameptr++ = PATHDELIMITERCHAR;
+	    }
+	    strcpy(nameptr, (const char*)(entryptr+1));
+	    copy_index_subtree(relpath);
+	    relpath[relpathlength] = '\0';
+	}
+    }
+}
+
+
+/*******************************************************************************
+Refresh the index of directory pathname (at recursiondepth), whose mtime (just
+stat'ed) is mtime_s & mtime_ns, and select its entries as process_path and
+process_object would. If its mtime is the same as in the previous index, its
+entries are taken from there, but those that will be selected (by type and name)
+or traversed are stat'ed again: a file's contents can change without its
+directory's mtime changing. If not, all of its entries are read and stat'ed
+again. The directory is written to the new index. Only the subdirectories that
+would be traversed are refreshed (pushed onto dirstack, see
+traverse_indexed_directory). The trees of the others are copied from the
+previous index (see copy_index_subtree).
+*******************************************************************************/
+void process_indexed_directory(const char *pathname, time_t mtime_s, time_t mtime_ns, int recursiondepth) {
+    Indexdirectory		indexdir;
+    const Indexdirectory	*olddirptr;
+    Indexentry			*entryptr;
+    Diritem			*diritemptr;
+    char			subpathname[MAXPATHLENGTH], subrelpath[MAXPATHLENGTH];
+    dev_t			device;
+    const char			*relpath, *entryname;
+    char			*entries;
+    size_t			offset;
+    int				dirfiledes, reusedflag, selectflag, traverseflag, namematch;
+
+    if ((dirfiledes=open(pathname, O_RDONLY|O_DIRECTORY)) == -1) {
+	fprintf(stderr, "W: opendir error - ");
+	perror(pathname);
+	returncode = 1;
+	return;
+    }
+
+    /* the pathname relative to the target: "" for the target itself */
+    relpath = pathname + indextargetlength;
+    if (*relpath == PATHDELIMITERCHAR) {
+	relpath++;
+    }
+
+    indexdir.mtime_s = mtime_s;
+    indexdir.mtime_ns = mtime_ns;
+    if ((olddirptr=find_index_directory(relpath)) != NULL &&
+		olddirptr->mtime_s == indexdir.mtime_s && olddirptr->mtime_ns == indexdir.mtime_ns) {
+	indexdir.entriessize = olddirptr->entriessize;
+	if ((entries=(char*)malloc(indexdir.entriessize+1)) == NULL) {
+	    perror("E: insufficient memory - malloc failed");
+	    exit(1);
+	}
+	memcpy(entries, (const char*)(olddirptr+1) + olddirptr->relpathsize, indexdir.entriessize);
+	reusedflag = 1;
+	numindexdirsreused++;
+    } else {
+	entries = read_index_entries(dirfiledes, pathname, &indexdir.entriessize);
+	reusedflag = 0;
+	numindexdirsread++;
+    }
+
+    /* select the entries, as process_path would, and refresh the subdirectories that are traversed */
+    for (offset=0; offset<indexdir.entriessize; offset+=sizeof(Indexentry)+entryptr->namesize) {
+	entryptr = (Indexentry*)(entries+offset);
+	entryname = (const char*)(entryptr+1);
+	namematch = NAMEMATCHUNKNOWN;
+	selectflag = S_ISREG(entryptr->type) ? regularfileflag : S_ISDIR(entryptr->type) ? directoryflag : otherobjectflag;
+	traverseflag = S_ISDIR(entryptr->type) && recursiveflag && (numprunes == 0 || !prune_directory(entryname));
+	if (reusedflag && (traverseflag || (selectflag && objectstatmask != STATX_TYPE &&
+			(namematch=match_object_name(entryname)))) && stat_index_entry(dirfiledes, entryname, entryptr) == -1) {
+	    fprintf(stderr, "W: process_path: Cannot access '%s'\n", build_pathname(subpathname, pathname, entryname));
+	    returncode = 1;
+	    indexdir.mtime_ns = UNSTABLEMTIME_NS;
+	    continue;
+	}
+	if (selectflag) {
+	    select_index_entry(pathname, entryptr, namematch);
+	}
+	if (traverseflag && (!devicecheckflag || check_directory_device(dirfiledes, entryname, &device))) {
+	    build_pathname(subpathname, pathname, entryname);
+	    if (recursiondepth+1 >= maxrecursiondepth) {
+		warn_untraversed_directory(subpathname, recursiondepth+1);
+		copy_index_subtree(build_pathname(subrelpath, *relpath == '\0' ? NULL : relpath, entryname));
+	    } else if (check_pathname_length(subpathname, recursiondepth+1)) {
+		diritemptr = stack_directory(subpathname, recursiondepth+1);
+		diritemptr->mtime_s = entryptr->mtime_s;
+		diritemptr->mtime_ns = entryptr->mtime_ns;
+	    }
+	} else if (S_ISDIR(entryptr->type) && !traverseflag) {	/* (no -r, or pruned) */
+	    copy_index_subtree(build_pathname(subrelpath, *relpath == '\0' ? NULL : relpath, entryname));
+	}
+    }
+
+    /* read it again next time if it couldn't be read, or if it could change without its mtime changing */
+    if (entries == NULL || indexdir.mtime_s >= indexrefreshtime_s-1) {
+	indexdir.mtime_ns = UNSTABLEMTIME_NS;
+    }
+    indexdir.relpathsize = INDEXALIGN(strlen(relpath)+1);
+    write_index_data(&indexdir, sizeof(Indexdirectory), sizeof(Indexdirectory));
+    write_index_data(relpath, strlen(relpath)+1, indexdir.relpathsize);
+    if (indexdir.entriessize > 0) {
+	write_index_data(entries, indexdir.entriessize, indexdir.entriessize);
+    }
+    free(entries);
+
+    if (close(dirfiledes)) {
+	perror(pathname);
+	returncode = 1;
+    }
+}
+
+
+/*******************************************************************************
+-I/--index: refresh the index of the tree below the directory pathname, whose
+mtime is mtime_s & mtime_ns, as traverse_directory reads a tree: one directory
+at a time (see process_indexed_directory), from dirstack.
+*******************************************************************************/
+void traverse_indexed_directory(const char *pathname, time_t mtime_s, time_t mtime_ns) {
+    Diritem	diritem, *diritemptr;
+    int		basenumstackeddirs = numstackeddirs, firstsubdiridx;
+
+    diritemptr = stack_directory(pathname, 0);
+    diritemptr->mtime_s = mtime_s;
+    diritemptr->mtime_ns = mtime_ns;
+    while (numstackeddirs > basenumstackeddirs) {
+	diritem = dirstack[--numstackeddirs];
+	firstsubdiridx = numstackeddirs;
+	process_indexed_directory(diritem.pathname, diritem.mtime_s, diritem.mtime_ns, diritem.recursiondepth);
+	reverse_stacked_directories(firstsubdiridx);
+	free(diritem.pathname);
+    }
+}
+
+
+/*******************************************************************************
+-I/--index: refresh the index file (indexfilename) of the target directory
+pathname, and select the objects in its tree from the refreshed index. Only the
+directories that are traversed (see process_indexed_directory) are refreshed -
+without -r, just the target. The new index is written to a temporary file, which
+then replaces the index file. Only one thread is used (-j and -q are ignored).
+*******************************************************************************/
+void process_target_with_index(char *pathname) {
+    Indexheader	indexheader;
+    struct stat	statinfo;
+    char	newindexfilename[MAXPATHLENGTH];
+    char	*newindexbuffer;
+
+    if (followsymlinksflag || uniqueflag) {
+	fprintf(stderr, "E: -I/--index cannot be used with -L/--symlinks or -Z/--unique, aborting\n");
+	exit(1);
+    }
+    load_index(pathname);
+
+    if (snprintf(newindexfilename, MAXPATHLENGTH, "%s.tmp%ld", indexfilename, (long)getpid()) >= MAXPATHLENGTH ||
+		(newindexfileptr=fopen(newindexfilename, "w")) == NULL) {
+	fprintf(stderr, "E: Cannot create index file '%s': %s\n", newindexfilename, strerror(errno));
+	exit(1);
+    }
+    if ((newindexbuffer=(char*)malloc(INDEXBUFSIZE)) != NULL) {
+	setvbuf(newindexfileptr, newindexbuffer, _IOFBF, INDEXBUFSIZE);
+    }
+    memset(&indexheader, 0, sizeof(Indexheader));
+    memcpy(indexheader.magicstr, INDEXMAGICSTR, sizeof(INDEXMAGICSTR));
+    indexheader.entrysize = sizeof(Indexentry);
+    indexheader.targetsize = INDEXALIGN(strlen(pathname)+1);
+    write_index_data(&indexheader, sizeof(Indexheader), INDEXHEADERSIZE);
+    write_index_data(pathname, strlen(pathname)+1, indexheader.targetsize);
+
+    indextargetlength = strlen(pathname);
+    indexrefreshtime_s = time(NULL);
+    numindexdirsread = numindexdirsreused = 0;
+    if (stat(pathname, &statinfo) == -1) {	/* a target symlink/ is followed */
+	fprintf(stderr, "W: opendir error - ");
+	perror(pathname);
+	returncode = 1;
+    } else {
+	traverse_indexed_directory(pathname, statinfo.st_mtime, statinfo.st_mtim.tv_nsec);
+    }
+
+    if (fclose(newindexfileptr) || rename(newindexfilename, indexfilename)) {
+	fprintf(stderr, "E: Cannot write index file '%s': %s\n", indexfilename, strerror(errno));
+	unlink(newindexfilename);
+	exit(1);
+    }
+    free(newindexbuffer);
+    free(indexhashtable);
+    free(indexbuffer);
+    indexhashtable = NULL;
+    indexbuffer = NULL;
+    indexhashsize = 0;
+
+    if (verbosity > 1) {
+	fprintf(stderr, "i: Index '%s': %ld directories read, %ld unchanged\n", indexfilename, numindexdirsread, numindexdirsreused);
+    }
+}
+
+
+/*******************************************************************************
+Return the watched directory with (real) pathname, or NULL if there isn't one.
+*******************************************************************************/
+Watchdirectory *find_watched_directory_by_real_pathname(const char *pathname) {
+    Watchdirectory	*watchdirptr;
+
+    for (watchdirptr=watchhashtable[hash_string(pathname) & (watchhashsize-1)]; watchdirptr!=NULL;
+								watchdirptr=watchdirptr->hashnextptr) {
+	if (!strcmp(watchdirptr->pathname, pathname)) {
+	    return watchdirptr;
+	}
+    }
+    return NULL;
+}
+
+
+/*******************************************************************************
+Return the watched directory that pathname (a query's target) resolves to, or
+NULL if it isn't in one of the daemon's watched trees.
+*******************************************************************************/
+Watchdirectory *find_watched_directory(const char *pathname) {
+    char	realpathname[PATH_MAX];
+
+    if (realpath(pathname, realpathname) == NULL) {
+	return NULL;
+    }
+    return find_watched_directory_by_real_pathname(realpathname);
+}
+
+
+/*******************************************************************************
+Select the entries of the watched directory *watchdirptr (whose pathname in the
+query is pathname, at recursiondepth) from memory, as process_indexed_directory
+does. Its subdirectories are pushed onto dirstack (see
+process_watched_directory).
+*******************************************************************************/
+void select_watched_directory(const Watchdirectory *watchdirptr, const char *pathname, int recursiondepth) {
+    const Indexentry	*entryptr;
+    Watchdirectory	*subdirptr;
+    char		subpathname[MAXPATHLENGTH], realsubpathname[MAXPATHLENGTH];
+    size_t		offset;
+    dev_t		device;
+
+    for (offset=0; offset<watchdirptr->entriessize; offset+=sizeof(Indexentry)+entryptr->namesize) {
+	entryptr = (const Indexentry*)(watchdirptr->entries+offset);
+	select_index_entry(pathname, entryptr, NAMEMATCHUNKNOWN);
+	if (S_ISDIR(entryptr->type) && recursiveflag &&
+		(numprunes == 0 || !prune_directory((const char*)(entryptr+1))) &&
+		(!devicecheckflag || check_directory_device(AT_FDCWD, build_pathname(realsubpathname,
+					watchdirptr->pathname, (const char*)(entryptr+1)), &device))) {
+	    build_pathname(subpathname, pathname, (const char*)(entryptr+1));
+	    if (recursiondepth+1 >= maxrecursiondepth) {
+		warn_untraversed_directory(subpathname, recursiondepth+1);
+	    } else if (check_pathname_length(subpathname, recursiondepth+1)) {
+		/* (if it's not watched, eg, because it couldn't be read when it was last refreshed, it's read now) */
+		subdirptr = find_watched_directory_by_real_pathname(
+			build_pathname(realsubpathname, watchdirptr->pathname, (const char*)(entryptr+1)));
+		stack_directory(subpathname, recursiondepth+1)->watchdirptr = subdirptr;
+	    }
+	}
+    }
+}
+
+
+/*******************************************************************************
+Select the objects in the tree below the watched directory *watchdirptr (whose
+pathname in the query is pathname) down to the query's depth, as
+traverse_directory does: one directory at a time (see select_watched_directory),
+from dirstack.
+*******************************************************************************/
+void process_watched_directory(Watchdirectory *watchdirptr, char *pathname) {
+    Diritem	diritem;
+    int		basenumstackeddirs = numstackeddirs, firstsubdiridx;
+
+    stack_directory(pathname, 0)->watchdirptr = watchdirptr;
+    while (numstackeddirs > basenumstackeddirs) {
+	diritem = dirstack[--numstackeddirs];
+	firstsubdiridx = numstackeddirs;
+	if (diritem.watchdirptr != NULL) {
+	    select_watched_directory(diritem.watchdirptr, diritem.pathname, diritem.recursiondepth);
+	    reverse_stacked_directories(firstsubdiridx);
+	} else {
+	    traverse_directory(diritem.pathname, diritem.recursiondepth);
+	}
+	free(diritem.pathname);
+    }
+}
+
+
+#if HAVEINOTIFY
+/*******************************************************************************
+Queue the watched directory *watchdirptr to be refreshed (see
+refresh_watched_directories).
+*******************************************************************************/
+void mark_watched_directory_dirty(Watchdirectory *watchdirptr) {
+    if (watchdirptr->dirtyflag || watchdirptr->removedflag) {
+	return;
+    }
+    if (numdirtywatchdirs >= maxdirtywatchdirs) {
+	maxdirtywatchdirs = maxdirtywatchdirs > 0 ? maxdirtywatchdirs * 2 : INITDIRDEQUESIZE;
+	if ((dirtywatchtable=(Watchdirectory**)realloc(dirtywatchtable, maxdirtywatchdirs*sizeof(Watchdirectory*))) == NULL) {
+	    perror("E: insufficient memory - realloc failed");
+	    exit(1);
+	}
+    }
+    watchdirptr->dirtyflag = 1;
+    dirtywatchtable[numdirtywatchdirs++] = watchdirptr;
+}
+
+
+/*******************************************************************************
+Add an inotify watch to the directory *watchdirptr. If that's not possible (eg,
+the inotify watch limit has been reached), it's refreshed before each query.
+*******************************************************************************/
+void add_directory_watch(Watchdirectory *watchdirptr) {
+    int		watchdes;
+
+    if ((watchdes=inotify_add_watch(inotifyfiledes, watchdirptr->pathname, WATCHEVENTMASK)) == -1) {
+	if (errno == ENOSPC && !watchlimitwarningflag) {
+	    fprintf(stderr, "W: The inotify watch limit (/proc/sys/fs/inotify/max_user_watches) has been reached\n");
+	    watchlimitwarningflag = 1;
+	}
+	if (watchdirptr->watchdes != -1 || watchdirptr->generation == watchgeneration) {
+	    numunwatcheddirs++;
+	}
+	watchdirptr->watchdes = -1;
+	return;
+    }
+    if (watchdes >= maxwatchdes) {
+	int	oldmaxwatchdes = maxwatchdes;
+
+	for (maxwatchdes=maxwatchdes>0 ? maxwatchdes : INITDIRDEQUESIZE; maxwatchdes<=watchdes; maxwatchdes*=2) {
+	    ;
+	}
+	if ((watchdestable=(Watchdirectory**)realloc(watchdestable, maxwatchdes*sizeof(Watchdirectory*))) == NULL) {
+	    perror("E: insufficient memory - realloc failed");
+	    exit(1);
+	}
+	memset(watchdestable+oldmaxwatchdes, 0, (maxwatchdes-oldmaxwatchdes)*sizeof(Watchdirectory*));
+    }
+    watchdestable[watchdes] = watchdirptr;	/* a directory moved within a tree keeps its watch descriptor */
+    watchdirptr->watchdes = watchdes;
+}
+#endif
+
+
+/*******************************************************************************
+Read the entries of the watched directory *watchdirptr (again). Subdirectories
+that have appeared are scanned (see scan_watched_directory) and those that have
+disappeared are removed (with their subtrees). Its own entry in its parent's
+entries is updated too, because its parent isn't told when its mtime changes.
+*******************************************************************************/
+void refresh_watched_directory(Watchdirectory *watchdirptr) {
+    const Indexentry	*entryptr;
+    Indexentry		*parententryptr;
+    Watchdirectory	*subdirptr;
+    char		subpathname[MAXPATHLENGTH];
+    char		*oldentries, *newentries;
+    size_t		offset, oldentriessize, newentriessize;
+    int			dirfiledes;
+
+    watchdirptr->dirtyflag = 0;
+#if HAVEINOTIFY
+    if (watchdirptr->watchdes == -1) {
+	add_directory_watch(watchdirptr);
+	if (watchdirptr->watchdes != -1) {
+	    numunwatcheddirs--;
+	}
+    }
+#endif
+    if ((dirfiledes=open(watchdirptr->pathname, O_RDONLY|O_DIRECTORY)) == -1) {
+	newentries = NULL;
+	newentriessize = 0;
+    } else {
+	newentries = read_index_entries(dirfiledes, watchdirptr->pathname, &newentriessize);
+	close(dirfiledes);
+    }
+    oldentries = watchdirptr->entries;
+    oldentriessize = watchdirptr->entriessize;
+    watchdirptr->entries = newentries;
+    watchdirptr->entriessize = newentriessize;
+
+    /* which subdirectories are still there (removing the others first), and which are new? */
+    watchgeneration++;
+    for (offset=0; offset<newentriessize; offset+=sizeof(Indexentry)+entryptr->namesize) {
+	entryptr = (const Indexentry*)(newentries+offset);
+	if (S_ISDIR(entryptr->type) && (subdirptr=find_watched_directory_by_real_pathname(
+		build_pathname(subpathname, watchdirptr->pathname, (const char*)(entryptr+1)))) != NULL) {
+	    subdirptr->generation = watchgeneration;
+	}
+    }
+    for (offset=0; offset<oldentriessize; offset+=sizeof(Indexentry)+entryptr->namesize) {
+	entryptr = (const Indexentry*)(oldentries+offset);
+	if (S_ISDIR(entryptr->type) && (subdirptr=find_watched_directory_by_real_pathname(
+		build_pathname(subpathname, watchdirptr->pathname, (const char*)(entryptr+1)))) != NULL &&
+		subdirptr->generation != watchgeneration) {
+	    remove_watched_directory(subdirptr);
+	}
+    }
+    free(oldentries);
+    for (offset=0; offset<newentriessize; offset+=sizeof(Indexentry)+entryptr->namesize) {
+	entryptr = (const Indexentry*)(newentries+offset);
+	if (S_ISDIR(entryptr->type) && find_watched_directory_by_real_pathname(
+		build_pathname(subpathname, watchdirptr->pathname, (const char*)(entryptr+1))) == NULL) {
+	    scan_watched_directory(subpathname, watchdirptr);
+	}
+    }
+
+    /* update its own entry in its parent's entries */
+    if (watchdirptr->parentptr != NULL) {
+	for (offset=0; offset<watchdirptr->parentptr->entriessize; offset+=sizeof(Indexentry)+parententryptr->namesize) {
+	    parententryptr = (Indexentry*)(watchdirptr->parentptr->entries+offset);
+	    if (!strcmp((const char*)(parententryptr+1), watchdirptr->name)) {
+		if (stat_index_entry(AT_FDCWD, watchdirptr->pathname, parententryptr) == -1) {
+		    mark_watched_directory_dirty(watchdirptr->parentptr);	/* it's gone */
+		}
+		break;
+	    }
+	}
+    }
+}
+
+
+/*******************************************************************************
+Add the directory pathname (a real pathname), whose parent is the watched
+directory *parentptr (NULL for a target), to the watched directories, and read
+its entries. Its subdirectories are pushed onto dirstack (see
+scan_watched_directory).
+*******************************************************************************/
+void add_watched_directory(const char *pathname, Watchdirectory *parentptr) {
+    Watchdirectory	*watchdirptr, *subdirptr, **oldhashtable;
+    const Indexentry	*entryptr;
+    char		subpathname[MAXPATHLENGTH];
+    size_t		offset, oldhashsize, hashidx;
+    int			dirfiledes;
+    dev_t		device;
+
+    /* grow the hash table (rehashing all the directories) when it's 3/4 full */
+    if (4*(numwatchdirs+1) > 3*watchhashsize) {
+	oldhashtable = watchhashtable;
+	oldhashsize = watchhashsize;
+	watchhashsize = watchhashsize > 0 ? watchhashsize * 2 : INITDIRDEQUESIZE;
+	if ((watchhashtable=(Watchdirectory**)calloc(watchhashsize, sizeof(Watchdirectory*))) == NULL) {
+	    perror("E: insufficient memory - calloc failed");
+	    exit(1);
+	}
+	for (hashidx=0; hashidx<oldhashsize; hashidx++) {
+	    while ((watchdirptr=oldhashtable[hashidx]) != NULL) {
+		oldhashtable[hashidx] = watchdirptr->hashnextptr;
+		watchdirptr->hashnextptr = watchhashtable[hash_string(watchdirptr->pathname) & (watchhashsize-1)];
+		watchhashtable[hash_string(watchdirptr->pathname) & (watchhashsize-1)] = watchdirptr;
+	    }
+	}
+	free(oldhashtable);
+    }
+
+    if ((watchdirptr=(Watchdirectory*)calloc(1, sizeof(Watchdirectory))) == NULL ||
+		(watchdirptr->pathname=strdup(pathname)) == NULL) {
+	perror("E: insufficient memory - calloc failed");
+	exit(1);
+    }
+    watchdirptr->name = parentptr == NULL ? watchdirptr->pathname : watchdirptr->pathname+strlen(parentptr->pathname)+
+				(watchdirptr->pathname[strlen(parentptr->pathname)] == PATHDELIMITERCHAR);
+    watchdirptr->parentptr = parentptr;
+    watchdirptr->generation = watchgeneration;
+    watchdirptr->watchdes = -1;
+    hashidx = hash_string(pathname) & (watchhashsize-1);
+    watchdirptr->hashnextptr = watchhashtable[hashidx];
+    watchhashtable[hashidx] = watchdirptr;
+    numwatchdirs++;
+
+#if HAVEINOTIFY
+    if (inotifyfiledes != -1) {
+	add_directory_watch(watchdirptr);	/* before reading it, so no change is missed */
+    }
+#endif
+    if ((dirfiledes=open(pathname, O_RDONLY|O_DIRECTORY)) == -1) {
+	fprintf(stderr, "W: opendir error - ");
+	perror(pathname);
+	returncode = 1;
+	return;
+    }
+    watchdirptr->entries = read_index_entries(dirfiledes, pathname, &watchdirptr->entriessize);
+    close(dirfiledes);
+    for (offset=0; offset<watchdirptr->entriessize; offset+=sizeof(Indexentry)+entryptr->namesize) {
+	entryptr = (const Indexentry*)(watchdirptr->entries+offset);
+	if (S_ISDIR(entryptr->type)) {
+	    build_pathname(subpathname, pathname, (const char*)(entryptr+1));
+	    if (devicecheckflag && !check_directory_device(AT_FDCWD, subpathname, &device)) {
+		continue;
+	    } else if ((subdirptr=find_watched_directory_by_real_pathname(subpathname)) == NULL) {
+		if (check_pathname_length(subpathname, 0)) {
+		    stack_directory(subpathname, 0)->watchdirptr = watchdirptr;
+		}
+	    } else if (subdirptr->parentptr == NULL) {	/* a target (scanned first) within this one */
+		subdirptr->parentptr = watchdirptr;
+		subdirptr->name = subdirptr->pathname + strlen(pathname) + (subdirptr->pathname[strlen(pathname)] == PATHDELIMITERCHAR);
+	    }
+	}
+    }
+}
+
+
+/*******************************************************************************
+Add the directory pathname (a real pathname), whose parent is the watched
+directory *parentptr (NULL for a target), and its subtree to the watched
+directories, as traverse_directory reads a tree: one directory at a time (see
+add_watched_directory), from dirstack.
+*******************************************************************************/
+void scan_watched_directory(const char *pathname, Watchdirectory *parentptr) {
+    Diritem	diritem;
+    int		basenumstackeddirs = numstackeddirs;
+
+    stack_directory(pathname, 0)->watchdirptr = parentptr;
+    while (numstackeddirs > basenumstackeddirs) {
+	diritem = dirstack[--numstackeddirs];
+	add_watched_directory(diritem.pathname, diritem.watchdirptr);
+	free(diritem.pathname);
+    }
+}
+
+
+/*******************************************************************************
+Remove the watched directory *watchdirptr and its subtree. The directories are
+unhashed now, but only freed after the current refresh (see
+refresh_watched_directories), because they may still be queued to be refreshed.
+*******************************************************************************/
+void remove_watched_directory(Watchdirectory *watchdirptr) {
+    const Indexentry	*entryptr;
+    Watchdirectory	*subdirptr, **hashlinkptr;
+    char		subpathname[MAXPATHLENGTH];
+    size_t		offset;
+
+    for (offset=0; offset<watchdirptr->entriessize; offset+=sizeof(Indexentry)+entryptr->namesize) {
+	entryptr = (const Indexentry*)(watchdirptr->entries+offset);
+	if (S_ISDIR(entryptr->type) && (subdirptr=find_watched_directory_by_real_pathname(
+		build_pathname(subpathname, watchdirptr->pathname, (const char*)(entryptr+1)))) != NULL &&
+		subdirptr->parentptr == watchdirptr) {
+	    remove_watched_directory(subdirptr);
+	}
+    }
+#if HAVEINOTIFY
+    if (watchdirptr->watchdes == -1) {
+	numunwatcheddirs--;
+    } else if (watchdestable[watchdirptr->watchdes] == watchdirptr) {	/* not moved elsewhere in a tree */
+	inotify_rm_watch(inotifyfiledes, watchdirptr->watchdes);
+	watchdestable[watchdirptr->watchdes] = NULL;
+    }
+#endif
+    for (hashlinkptr=&watchhashtable[hash_string(watchdirptr->pathname) & (watchhashsize-1)];
+				*hashlinkptr!=watchdirptr; hashlinkptr=&(*hashlinkptr)->hashnextptr) {
+	;
+    }
+    *hashlinkptr = watchdirptr->hashnextptr;
+    numwatchdirs--;
+    watchdirptr->removedflag = 1;
+    watchdirptr->hashnextptr = removedwatchlistptr;
+    removedwatchlistptr = watchdirptr;
+}
+
+
+/*******************************************************************************
+-w/--watch: add the target directory pathname's tree to the watched directories.
+*******************************************************************************/
+void watch_target(const char *pathname) {
+    struct stat	statinfo;
+    char	realpathname[PATH_MAX];
+
+    if (realpath(pathname, realpathname) == NULL || stat(realpathname, &statinfo) == -1) {
+	fprintf(stderr, "W: Cannot watch '%s': %s\n", pathname, strerror(errno));
+	returncode = 1;
+    } else if (!S_ISDIR(statinfo.st_mode)) {
+	fprintf(stderr, "W: Cannot watch '%s': not a directory\n", pathname);
+	returncode = 1;
+    } else if (watchhashtable == NULL || find_watched_directory_by_real_pathname(realpathname) == NULL) {
+	targetdevice = statinfo.st_dev;
+	scan_watched_directory(realpathname, NULL);
+    }
+}
+
+
+#if HAVEINOTIFY
+/*******************************************************************************
+Read the pending inotify events (if any), and refresh the directories they are
+about. Directories that aren't watched (see add_directory_watch) are refreshed
+too, if refreshallflag is set (ie, before each query). Reading a file (IN_ACCESS)
+refreshes its directory, as its atime may have changed, but reading a directory
+doesn't (so directories' own atimes are not kept current).
+*******************************************************************************/
+void refresh_watched_directories(int refreshallflag) {
+    char			eventbuffer[WATCHEVENTBUFSIZE] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+    const struct inotify_event	*eventptr;
+    Watchdirectory		*watchdirptr;
+    ssize_t			numbytesread;
+    size_t			idx;
+    char			*cptr;
+
+    while ((numbytesread=read(inotifyfiledes, eventbuffer, sizeof(eventbuffer))) > 0) {
+	for (cptr=eventbuffer; cptr<eventbuffer+numbytesread; cptr+=sizeof(struct inotify_event)+eventptr->len) {
+	    eventptr = (const struct inotify_event*)cptr;
+	    if (eventptr->mask & IN_Q_OVERFLOW) {	/* events were lost: refresh everything */
+		for (idx=0; idx<watchhashsize; idx++) {
+		    for (watchdirptr=watchhashtable[idx]; watchdirptr!=NULL; watchdirptr=watchdirptr->hashnextptr) {
+			mark_watched_directory_dirty(watchdirptr);
+		    }
+		}
+	    } else if ((eventptr->mask & (IN_ACCESS|IN_ISDIR)) == (IN_ACCESS|IN_ISDIR) ||
+			(eventptr->mask & IN_ACCESS && eventptr->len == 0)) {
+		;	/* a directory was read (eg, by a refresh): that would refresh its parent, and so on */
+	    } else if (eventptr->wd >= 0 && eventptr->wd < maxwatchdes && (watchdirptr=watchdestable[eventptr->wd]) != NULL) {
+		if (eventptr->mask & IN_IGNORED) {	/* its watch is gone (eg, it was removed) */
+		    watchdestable[eventptr->wd] = NULL;
+		    watchdirptr->watchdes = -1;
+		    numunwatcheddirs++;
+		}
+		mark_watched_directory_dirty(watchdirptr);
+	    }
+	}
+    }
+    if (refreshallflag && numunwatcheddirs > 0) {
+	for (idx=0; idx<watchhashsize; idx++) {
+	    for (watchdirptr=watchhashtable[idx]; watchdirptr!=NULL; watchdirptr=watchdirptr->hashnextptr) {
+		if (watchdirptr->watchdes == -1) {
+		    mark_watched_directory_dirty(watchdirptr);
+		}
+	    }
+	}
+    }
+
+    for (idx=0; idx<numdirtywatchdirs; idx++) {	/* refreshing can queue more */
+	if (!dirtywatchtable[idx]->removedflag) {
+	    refresh_watched_directory(dirtywatchtable[idx]);
+	}
+    }
+    numdirtywatchdirs = 0;
+    while ((watchdirptr=removedwatchlistptr) != NULL) {
+	removedwatchlistptr = watchdirptr->hashnextptr;
+	free(watchdirptr->entries);
+	free(watchdirptr->pathname);
+	free(watchdirptr);
+    }
+}
+
+
+/*******************************************************************************
+Answer a query (in a child process of the daemon) from the client connected to
+connectiondes. The client sends its stdout, stderr and current directory file
+descriptors, then its arguments: the number of them, then each one, all '\0'
+terminated. The query is processed like a command line (with the default
+options: the daemon has none, see run_daemon), then its return code is sent back
+(one byte). Options that read or write files, or start another daemon or client
+(WATCHQUERYBADOPTIONS), are rejected.
+*******************************************************************************/
+void answer_query(int connectiondes, int listendes) {
+    struct msghdr	message;
+    struct iovec	iovector;
+    struct cmsghdr	*cmsgptr;
+    union {
+	char		buffer[CMSG_SPACE(3*sizeof(int))];
+	struct cmsghdr	alignment;
+    } controlmessage;
+    char		*requestbuffer, *oldrequestbuffer, *cptr, **queryargv;
+    size_t		requestsize, maxrequestsize;
+    ssize_t		numbytesread;
+    int			filedestable[3], queryargc, argidx;
+    unsigned char	querycode;
+
+    maxrequestsize = 4096;
+    if ((requestbuffer=(char*)malloc(maxrequestsize)) == NULL) {
+	_exit(1);
+    }
+    iovector.iov_base = requestbuffer;
+    iovector.iov_len = maxrequestsize;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &iovector;
+    message.msg_iovlen = 1;
+    message.msg_control = controlmessage.buffer;
+    message.msg_controllen = sizeof(controlmessage.buffer);
+    if ((numbytesread=recvmsg(connectiondes, &message, 0)) <= 0 || (cmsgptr=CMSG_FIRSTHDR(&message)) == NULL ||
+		cmsgptr->cmsg_type != SCM_RIGHTS || cmsgptr->cmsg_len != CMSG_LEN(3*sizeof(int))) {
+	_exit(1);
+    }
+    memcpy(filedestable, CMSG_DATA(cmsgptr), sizeof(filedestable));
+    for (requestsize=numbytesread; (numbytesread=read(connectiondes, requestbuffer+requestsize, maxrequestsize-requestsize)) > 0; ) {
+	if ((requestsize+=numbytesread) == maxrequestsize) {
+	    maxrequestsize *= 2;
+	    oldrequestbuffer = requestbuffer;
+	    if ((requestbuffer=(char*)realloc(requestbuffer, maxrequestsize)) == NULL) {
+		free(oldrequestbuffer);		/* Only here to make Cppcheck happy */
+		_exit(1);
+	    }
+	}
+    }
+
+    /* the query's own stdout, stderr & current directory */
+    if (dup2(filedestable[0], STDOUT_FILENO) == -1 || dup2(filedestable[1], STDERR_FILENO) == -1 ||
+		fchdir(filedestable[2]) == -1) {
+	_exit(1);
+    }
+    close(filedestable[0]);
+    close(filedestable[1]);
+    close(filedestable[2]);
+    close(listendes);
+    close(inotifyfiledes);
+
+    /* split the request into the query's arguments */
+    if (requestsize == 0 || requestbuffer[requestsize-1] != '\0' || (queryargc=atoi(requestbuffer)+1) < 1 ||
+		(queryargv=(char**)calloc(queryargc+1, sizeof(char*))) == NULL) {
+	fprintf(stderr, "E: Invalid query\n");
+	_exit(1);
+    }
+    queryargv[0] = "findfiles";
+    cptr = requestbuffer + strlen(requestbuffer) + 1;
+    for (argidx=1; argidx<queryargc; argidx++) {
+	if (cptr >= requestbuffer+requestsize) {
+	    fprintf(stderr, "E: Invalid query\n");
+	    _exit(1);
+	}
+	queryargv[argidx] = cptr;
+	cptr += strlen(cptr) + 1;
+    }
+
+    watchsocketname = NULL;		/* the query's targets are searched (from memory, if watched) */
+    watchqueryflag = 1;
+    numtargets = 0;
+    verbosity = 0;			/* the daemon's own */
+    if (queryargc <= 1) {
+	display_usage_message(queryargv[0]);
+    } else {
+	for (argidx=1; argidx<queryargc; argidx++) {
+	    if (!strncmp(queryargv[argidx], "--", 2)) {
+		command_line_long_to_short(queryargv[argidx]);
+	    }
+	}
+	set_starttime();
+	optind = 0;			/* (re)initialize getopt */
+	process_command_line(queryargc, queryargv);
+    }
+    fflush(stdout);
+    fflush(stderr);
+    querycode = returncode;
+    if (write(connectiondes, &querycode, 1) != 1) {
+	_exit(1);
+    }
+    _exit(returncode);
+}
+
+
+/*******************************************************************************
+-w/--watch: run the daemon. Listen for queries on the Unix socket watchsocketname
+and answer each of them in a child process (which has a copy of the watched
+directories' information). Between queries, the watched directories are kept
+current with inotify. Only the daemon's user can connect (the socket's mode is
+0600, and each client's uid is checked), as the queries run with the daemon's
+privileges. The daemon's command line can only have -w, -v and targets, so each
+query starts with the default options. This never returns.
+*******************************************************************************/
+void run_daemon() {
+    struct sockaddr_un	socketaddress;
+    struct pollfd	pollfdtable[2];
+    struct stat		statinfo;
+    struct ucred	peercred;
+    socklen_t		peercredlength;
+    mode_t		oldumask;
+    int			listendes, connectiondes, bindresult = -1;
+    unsigned char	querycode;
+    pid_t		pid;
+
+    if (numqueryoptions > 0) {
+	fprintf(stderr, "E: -w/--watch only accepts -v and targets (give the other options with each query), aborting\n");
+	exit(1);
+    }
+    if (numwatchdirs == 0) {
+	fprintf(stderr, "E: There are no directories to watch, aborting\n");
+	exit(1);
+    }
+    memset(&socketaddress, 0, sizeof(socketaddress));
+    socketaddress.sun_family = AF_UNIX;
+    if (strlen(watchsocketname) >= sizeof(socketaddress.sun_path)) {
+	fprintf(stderr, "E: Socket pathname '%s' is too long, aborting\n", watchsocketname);
+	exit(1);
+    }
+    strcpy(socketaddress.sun_path, watchsocketname);
+    if (lstat(watchsocketname, &statinfo) == 0 && S_ISSOCK(statinfo.st_mode)) {
+	unlink(watchsocketname);	/* left by a previous daemon */
+    }
+    if ((listendes=socket(AF_UNIX, SOCK_STREAM, 0)) != -1) {
+	oldumask = umask(S_IRWXG|S_IRWXO);	/* no window where others could connect */
+	bindresult = bind(listendes, (struct sockaddr*)&socketaddress, sizeof(socketaddress));
+	umask(oldumask);
+    }
+    if (listendes == -1 || bindresult == -1 || chmod(watchsocketname, S_IRUSR|S_IWUSR) == -1 ||
+		listen(listendes, WATCHLISTENBACKLOG) == -1) {
+	fprintf(stderr, "E: Cannot listen on socket '%s': %s\n", watchsocketname, strerror(errno));
+	exit(1);
+    }
+    signal(SIGCHLD, SIG_IGN);		/* the query processes are reaped automatically */
+    signal(SIGPIPE, SIG_IGN);
+
+    if (verbosity > 1) {
+	fprintf(stderr, "i: Watching %ld directories, listening on '%s'\n", (long)numwatchdirs, watchsocketname);
+    }
+    pollfdtable[0].fd = listendes;
+    pollfdtable[0].events = POLLIN;
+    pollfdtable[1].fd = inotifyfiledes;
+    pollfdtable[1].events = POLLIN;
+    for (;;) {
+	if (poll(pollfdtable, 2, -1) == -1) {
+	    if (errno == EINTR) {
+		continue;
+	    }
+	    perror("E: poll failed");
+	    exit(1);
+	}
+	if (pollfdtable[1].revents & POLLIN) {
+	    refresh_watched_directories(0);
+	}
+	if (pollfdtable[0].revents & POLLIN) {
+	    if ((connectiondes=accept(listendes, NULL, NULL)) == -1) {
+		continue;
+	    }
+	    peercredlength = sizeof(peercred);
+	    peercred.uid = (uid_t)-1;
+	    if (getsockopt(connectiondes, SOL_SOCKET, SO_PEERCRED, &peercred, &peercredlength) == -1 ||
+			peercred.uid != geteuid()) {
+		fprintf(stderr, "W: Rejected a query from another user (uid %ld)\n", (long)peercred.uid);
+		querycode = WATCHREJECTEDCODE;
+		if (write(connectiondes, &querycode, 1) != 1) {
+		    ;	/* (it's gone already) */
+		}
+		close(connectiondes);
+		continue;
+	    }
+	    refresh_watched_directories(1);	/* so the answer is current */
+	    fflush(stdout);
+	    fflush(stderr);
+	    if ((pid=fork()) == 0) {
+		answer_query(connectiondes, listendes);
+	    } else if (pid == -1) {
+		perror("W: fork failed");
+	    }
+	    close(connectiondes);
+	}
+    }
+}
+#endif
+
+
+/*******************************************************************************
+-c/--client: send the query (the arguments after this option) to the
+daemon listening on the Unix socket socketname, with this process' stdout, stderr
+and current directory, so the daemon's answer goes straight to them. Exit with
+the query's return code. The daemon only answers its own user's queries.
+*******************************************************************************/
+void run_client(const char *socketname, int argc, char *argv[]) {
+    struct sockaddr_un	socketaddress;
+    struct msghdr	message;
+    struct iovec	iovector;
+    struct cmsghdr	*cmsgptr;
+    union {
+	char		buffer[CMSG_SPACE(3*sizeof(int))];
+	struct cmsghdr	alignment;
+    } controlmessage;
+    char		numargsstr[MAXINTEGERLENGTH];
+    int			socketdes, filedestable[3], argidx;
+    unsigned char	querycode;
+
+    if (argv[1][0] != '-' || argv[1][1] != 'c') {
+	fprintf(stderr, "E: -c/--client must be the first option, aborting\n");
+	exit(1);
+    }
+    memset(&socketaddress, 0, sizeof(socketaddress));
+    socketaddress.sun_family = AF_UNIX;
+    if (strlen(socketname) >= sizeof(socketaddress.sun_path)) {
+	fprintf(stderr, "E: Socket pathname '%s' is too long, aborting\n", socketname);
+	exit(1);
+    }
+    strcpy(socketaddress.sun_path, socketname);
+    if ((socketdes=socket(AF_UNIX, SOCK_STREAM, 0)) == -1 ||
+		connect(socketdes, (struct sockaddr*)&socketaddress, sizeof(socketaddress)) == -1) {
+	fprintf(stderr, "E: Cannot connect to the findfiles daemon at '%s': %s\n", socketname, strerror(errno));
+	exit(1);
+    }
+    if ((filedestable[2]=open(".", O_RDONLY|O_DIRECTORY)) == -1) {
+	perror("E: Cannot open the current directory");
+	exit(1);
+    }
+    filedestable[0] = STDOUT_FILENO;
+    filedestable[1] = STDERR_FILENO;
+    fflush(stdout);
+    fflush(stderr);
+    signal(SIGPIPE, SIG_IGN);		/* a rejected query's connection is closed early */
+
+    snprintf(numargsstr, MAXINTEGERLENGTH, "%d", argc-optind);
+    iovector.iov_base = numargsstr;
+    iovector.iov_len = strlen(numargsstr) + 1;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &iovector;
+    message.msg_iovlen = 1;
+    message.msg_control = controlmessage.buffer;
+    message.msg_controllen = sizeof(controlmessage.buffer);
+    cmsgptr = CMSG_FIRSTHDR(&message);
+    cmsgptr->cmsg_level = SOL_SOCKET;
+    cmsgptr->cmsg_type = SCM_RIGHTS;
+    cmsgptr->cmsg_len = CMSG_LEN(3*sizeof(int));
+    memcpy(CMSG_DATA(cmsgptr), filedestable, sizeof(filedestable));
+    argidx = optind;
+    if (sendmsg(socketdes, &message, 0) == -1) {
+	if (errno != EPIPE) {
+	    perror("E: Cannot send the query");
+	    exit(1);
+	}
+	argidx = argc;		/* (rejected, see below) */
+    }
+    for ( ; argidx<argc; argidx++) {
+	if (write(socketdes, argv[argidx], strlen(argv[argidx])+1) == -1) {
+	    if (errno == EPIPE) {
+		break;		/* (rejected, see below) */
+	    }
+	    perror("E: Cannot send the query");
+	    exit(1);
+	}
+    }
+    shutdown(socketdes, SHUT_WR);
+    switch (read(socketdes, &querycode, 1)) {
+	case 1:  if (querycode == WATCHREJECTEDCODE) {
+		     fprintf(stderr, "E: The findfiles daemon at '%s' only answers its own user's queries\n", socketname);
+		     exit(1);
+		 }							break;
+	case 0:  exit(1);	/* the query was aborted (and said why) */
+	default: fprintf(stderr, "E: No answer from the findfiles daemon at '%s'\n", socketname); exit(1);
+    }
+    exit(querycode);
+}
+
+
+/*******************************************************************************
+Split the query line (in place) into its arguments, separated by white space.
+Single quotes and double quotes quote (without the quotes themselves), and a
+backslash (outside single quotes) quotes the next character. Returns the number
+of arguments, or -1 if there's an unmatched quote.
+*******************************************************************************/
+int split_query_line(char *line, char *argtable[], int maxnumargs) {
+    char	*inptr, *outptr, quotechar;
+    int		numargs = 0;
+
+    for (inptr=line; ; ) {
+	while (isspace((unsigned char)*inptr)) {
+	    inptr++;
+	}
+	if (*inptr == '\0') {
+	    return numargs;
+	}
+	if (numargs >= maxnumargs) {
+	    return -1;
+	}
+	argtable[numargs++] = outptr = inptr;
+	for (quotechar='\0'; *inptr!='\0' && (quotechar!='\0' || !isspace((unsigned char)*inptr)); inptr++) {
+	    if (quotechar == '\0' && (*inptr == '\'' || *inptr == '"')) {
+		quotechar = *inptr;
+	    } else if (quotechar != '\0' && *inptr == quotechar) {
+		quotechar = '\0';
+	    } else if (quotechar != '\'' && *inptr == '\\' && inptr[1] != '\0') {
+		*outptr++ = *++inptr;
+	    } else {
+		*outptr++ = *inptr;
+	    }
+	}
+	if (quotechar != '\0') {
+	    return -1;
+	}
+	if (*inptr != '\0') {
+	    inptr++;
+	}
+	*outptr = '\0';
+    }
+}
+
+
+/*******************************************************************************
+-Q/--queries: read the directories of a query's targets into memory (as -w/--watch
+does, but without watching them), unless they already have been. The targets are
+found the way getopt (see process_command_line) will: arguments that aren't
+options or option arguments, and -t/--target arguments.
+*******************************************************************************/
+void scan_query_targets(int argc, char *argv[]) {
+    struct stat	statinfo;
+    const char	*optcharptr, *targetptr;
+    char	realpathname[PATH_MAX];
+    int		argidx;
+
+    for (argidx=1; argidx<argc; argidx++) {
+	targetptr = NULL;
+	if (argv[argidx][0] != '-' || argv[argidx][1] == '\0') {
+	    targetptr = argv[argidx];
+	} else {
+	    for (optcharptr=argv[argidx]+1; *optcharptr!='\0'; optcharptr++) {
+		const char *getoptptr = strchr(GETOPTSTR+1, *optcharptr);
+
+		if (*optcharptr != ':' && getoptptr != NULL && getoptptr[1] == ':') {	/* it has an argument */
+		    if (optcharptr[1] == '\0' && ++argidx >= argc) {
+			return;
+		    }
+		    if (*optcharptr == 't') {
+			targetptr = optcharptr[1] != '\0' ? optcharptr+1 : argv[argidx];
+		    }
+		    break;
+		}
+	    }
+	}
+	if (targetptr != NULL && realpath(targetptr, realpathname) != NULL && stat(realpathname, &statinfo) == 0 &&
+		S_ISDIR(statinfo.st_mode) &&
+		(watchhashtable == NULL || find_watched_directory_by_real_pathname(realpathname) == NULL)) {
+	    scan_watched_directory(realpathname, NULL);
+	}
+    }
+}
+
+
+/*******************************************************************************
+-Q/--queries: run the queries in queryfile ('-' for stdin), one per line (empty
+lines & lines starting with '#' are skipped), then exit. A query line has the
+usual OPTIONs & targets, optionally preceded by '>output_file'. Every distinct
+target directory is read once (see scan_query_targets). Then each query is run
+in its own (forked) process, so it starts with the options that preceded -Q,
+and its selected objects (and sort order, etc.) are its own. Each query's output
+is written to its output file, or else to stdout, after a '# query' line. -Q
+must be the last argument (argc is the number of arguments).
+*******************************************************************************/
+void run_batch_queries(char *filename, int argc) {
+    FILE	*queryfileptr;
+    char	**linetable = NULL, ***queryargvtable, **queryargv, line[MAXPATHLENGTH], *outputfilename;
+    int		*queryargctable, numlines = 0, maxnumlines = 0, lineidx, queryargc, status, outputfiledes;
+    pid_t	pid;
+
+    if (queryfilename != NULL || watchsocketname != NULL) {
+	fprintf(stderr, "E: -Q/--queries cannot be used in a query or with -w/--watch, aborting\n");
+	exit(1);
+    }
+    if (optind < argc) {
+	fprintf(stderr, "E: -Q/--queries must be the last argument (give the targets in the queries), aborting\n");
+	exit(1);
+    }
+    queryfilename = filename;
+    if (!strcmp(filename, "-")) {
+	queryfileptr = stdin;
+    } else if ((queryfileptr=fopen(filename, "r")) == NULL) {
+	fprintf(stderr, "E: Cannot open query file '%s': %s\n", filename, strerror(errno));
+	exit(1);
+    }
+    while (fgets(line, sizeof(line), queryfileptr) != NULL) {
+	if (strchr(line, '\n') == NULL && !feof(queryfileptr)) {
+	    fprintf(stderr, "E: Query %d is longer than %d characters, aborting\n", numlines+1, (int)sizeof(line)-2);
+	    exit(1);
+	}
+	line[strcspn(line, "\n")] = '\0';
+	if (numlines >= maxnumlines) {
+	    maxnumlines = maxnumlines > 0 ? maxnumlines * 2 : 16;
+	    if ((linetable=(char**)realloc(linetable, maxnumlines*sizeof(char*))) == NULL) {
+		perror("E: insufficient memory - realloc failed");
+		exit(1);
+	    }
+	}
+	if ((linetable[numlines++]=strdup(line)) == NULL) {
+	    perror("E: insufficient memory - strdup failed");
+	    exit(1);
+	}
+    }
+    if (queryfileptr != stdin) {
+	fclose(queryfileptr);
+    }
+
+    /* split every query (each argument vector is preceded by the "program name") and read its targets */
+    if ((queryargvtable=(char***)calloc(numlines+1, sizeof(char**))) == NULL ||
+		(queryargctable=(int*)calloc(numlines+1, sizeof(int))) == NULL) {
+	perror("E: insufficient memory - calloc failed");
+	exit(1);
+    }
+    for (lineidx=0; lineidx<numlines; lineidx++) {
+	if ((queryargv=(char**)calloc(strlen(linetable[lineidx])/2+3, sizeof(char*))) == NULL ||
+		(queryargv[1]=strdup(linetable[lineidx])) == NULL) {
+	    perror("E: insufficient memory - calloc failed");
+	    exit(1);
+	}
+	queryargv[0] = "findfiles";
+	if ((queryargc=split_query_line(queryargv[1], queryargv+1, strlen(linetable[lineidx])/2+1)) == -1) {
+	    fprintf(stderr, "E: Unmatched quote in query '%s', aborting\n", linetable[lineidx]);
+	    exit(1);
+	}
+	if (queryargc == 0 || queryargv[1][0] == '#') {
+	    continue;
+	}
+	queryargvtable[lineidx] = queryargv;
+	queryargctable[lineidx] = queryargc + 1;
+	for (queryargc=1; queryargc<queryargctable[lineidx]; queryargc++) {
+	    if (!strncmp(queryargv[queryargc], "--", 2)) {
+		command_line_long_to_short(queryargv[queryargc]);
+	    }
+	}
+	scan_query_targets(queryargctable[lineidx] - (queryargv[1][0] == '>'), queryargv + (queryargv[1][0] == '>'));
+    }
+
+    for (lineidx=0; lineidx<numlines; lineidx++) {
+	if ((queryargv=queryargvtable[lineidx]) == NULL) {
+	    continue;
+	}
+	queryargc = queryargctable[lineidx];
+	outputfilename = NULL;
+	if (queryargv[1][0] == '>') {
+	    outputfilename = queryargv[1] + 1;
+	    queryargv++;
+	    queryargc--;
+	} else {
+	    printf("# query %d: %s\n", lineidx+1, linetable[lineidx]);
+	}
+	fflush(stdout);
+	fflush(stderr);
+	if ((pid=fork()) == 0) {
+	    if (outputfilename != NULL) {
+		if ((outputfiledes=open(outputfilename, O_WRONLY|O_CREAT|O_TRUNC, 0666)) == -1 ||
+			dup2(outputfiledes, STDOUT_FILENO) == -1) {
+		    fprintf(stderr, "E: Cannot open output file '%s': %s\n", outputfilename, strerror(errno));
+		    _exit(1);
+		}
+		close(outputfiledes);
+	    }
+	    numtargets = 0;
+	    optind = 0;		/* (re)initialize getopt */
+	    process_command_line(queryargc, queryargv);
+	    fflush(stdout);
+	    fflush(stderr);
+	    _exit(returncode);
+	} else if (pid == -1) {
+	    perror("E: fork failed");
+	    exit(1);
+	}
+	if (waitpid(pid, &status, 0) == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+	    returncode = 1;
+	}
+    }
+    exit(returncode);
+}
+
+
+/*******************************************************************************
+-Y, -W & -J: set targetdevice to the device of the target directory pathname.
+*******************************************************************************/
+void set_target_device(const char *pathname) {
+    struct stat	statinfo;
+
+    targetdevice = stat(pathname, &statinfo) == 0 ? statinfo.st_dev : 0;
+}
+
+
+/*******************************************************************************
+-Y & -W: return 0 if a directory on device is not to be traversed: with -Y,
+because it's another device than the target's, or with -W, because it's a file
+system of a type to be skipped. Otherwise return 1.
+*******************************************************************************/
+int check_device(dev_t device) {
+    int		idx;
+
+    if (xdevflag && device != targetdevice) {
+	return 0;
+    }
+    for (idx=0; idx<numskipdevices; idx++) {
+	if (device == skipdevicetable[idx]) {
+	    return 0;
+	}
+    }
+    return 1;
+}
+
+
+/*******************************************************************************
+-Y, -W & -J: set *deviceptr to the device of the directory name (in the open
+directory dirfiledes), without triggering an automount, and check it (see
+check_device).
+*******************************************************************************/
+int check_directory_device(int dirfiledes, const char *name, dev_t *deviceptr) {
+    struct stat	statinfo;
+
+    if (fstatat(dirfiledes, name, &statinfo, (followsymlinksflag ? 0 : AT_SYMLINK_NOFOLLOW)|AT_NO_AUTOMOUNT) == -1) {
+	*deviceptr = targetdevice;
+	return 1;		/* opening it will fail, and say why */
+    }
+    *deviceptr = statinfo.st_dev;
+    return check_device(statinfo.st_dev);
+}
+
+
+/*******************************************************************************
+-W/--skip-fstype: don't traverse directories on file systems of the types in the
+comma separated list fstypes (eg, 'nfs,proc,sysfs'). The devices of all such file
+systems currently mounted are read from /proc/self/mountinfo, where each line is
+'ID parentID major:minor root mountpoint options [optional fields...] - fstype ...'.
+*******************************************************************************/
+void set_skip_file_system_types(const char *fstypes) {
+    FILE	*mountinfofileptr;
+    char	line[MAXMOUNTINFOLINELENGTH], fstype[MAXMOUNTINFOLINELENGTH];
+    const char	*cptr;
+    unsigned	majornumber, minornumber;
+    size_t	fstypelength;
+    int		maxnumskipdevices = numskipdevices;
+
+    if ((mountinfofileptr=fopen(MOUNTINFOFILENAME, "r")) == NULL) {
+	fprintf(stderr, "W: Cannot read '%s' (%s), ignoring -W '%s'\n", MOUNTINFOFILENAME, strerror(errno), fstypes);
+	return;
+    }
+    while (fgets(line, sizeof(line), mountinfofileptr) != NULL) {
+	if (sscanf(line, "%*d %*d %u:%u", &majornumber, &minornumber) != 2 || (cptr=strstr(line, " - ")) == NULL ||
+		sscanf(cptr+3, "%s", fstype) != 1) {
+	    continue;
+	}
+	fstypelength = strlen(fstype);
+	for (cptr=fstypes; *cptr!='\0'; cptr+=strcspn(cptr, ","), cptr+=(*cptr==',')) {
+	    if (strcspn(cptr, ",") == fstypelength && !strncmp(cptr, fstype, fstypelength)) {
+		if (numskipdevices >= maxnumskipdevices) {
+		    maxnumskipdevices = maxnumskipdevices > 0 ? maxnumskipdevices * 2 : INITSKIPDEVICES;
+		    if ((skipdevicetable=(dev_t*)realloc(skipdevicetable, maxnumskipdevices*sizeof(dev_t))) == NULL) {
+			perror("E: insufficient memory - realloc failed");
+			exit(1);
+		    }
+		}
+		skipdevicetable[numskipdevices++] = makedev(majornumber, minornumber);
+		if (verbosity > 1) {
+		    fprintf(stderr, "i: Skipping %s file system %u:%u\n", fstype, majornumber, minornumber);
+		}
+		break;
+	    }
+	}
+    }
+    fclose(mountinfofileptr);
+    devicecheckflag = 1;
+}
+
+
+/*******************************************************************************
+-J/--device-jobs: set the maximum number of threads (-j) that read directories on
+the same device at once.
+*******************************************************************************/
+void set_device_threads(const char *optarg) {
+    char	*endptr;
+    long	number;
+
+    number = strtol(optarg, &endptr, 10);
+    if (*optarg == '\0' || *endptr != '\0' || number < 0 || number > MAXNUMTHREADS) {
+	fprintf(stderr, "E: Illegal number of threads per device '%s' (must be 0 to %d)\n", optarg, MAXNUMTHREADS);
+	exit(1);
+    }
+    maxdevicethreads = number;
+    devicecheckflag = maxdevicethreads > 0 || xdevflag || numskipdevices > 0;
+}
+
+
+/*******************************************************************************
+Process a target - or with -w/--watch, add it to the watched directories.
+*******************************************************************************/
+void process_target(char *pathname) {
+    if (!check_pathname_length(pathname, 0)) {
+	;		/* (it said why) */
+    } else if (watchsocketname != NULL) {
+	watch_target(pathname);
+    } else {
+	process_path(AT_FDCWD, NULL, pathname, DT_UNKNOWN, 0, NULL, NULL, NAMEMATCHUNKNOWN);
+    }
+    numtargets++;
+    indexfilename = NULL;	/* -I only applies to one target */
+    resetpredicatekinds = (1 << PREDTIME) | (1 << PREDSIZE) | (1 << PREDUID);
+}
+
+
+/*******************************************************************************
+-w/--watch: set the daemon's socket pathname. Targets that follow are watched.
+*******************************************************************************/
+void set_watch_socket(char *optarg) {
+#if HAVEINOTIFY
+    if (watchhashtable != NULL) {
+	fprintf(stderr, "E: -w/--watch cannot be used in a query, aborting\n");
+	exit(1);
+    }
+    if (numtargets > 0) {
+	fprintf(stderr, "E: -w/--watch must precede the targets, aborting\n");
+	exit(1);
+    }
+    if (inotifyfiledes == -1 && (inotifyfiledes=inotify_init1(IN_NONBLOCK|IN_CLOEXEC)) == -1) {
+	perror("E: inotify_init1 failed");
+	exit(1);
+    }
+    watchsocketname = optarg;
+#else
+    fprintf(stderr, "E: -w/--watch (%s) requires inotify (Linux), aborting\n", optarg);
+    exit(1);
+#endif
+}
+
+
+/*******************************************************************************
+Strip any trailing '/' character(s) from pathname. This function is called when
+processing a directory or a symbolic link to a directory at recursion level 0
+(so, specified on the command line). It seems that many *NIX commands process
+'dirsymlink' and 'dirsymlink/' differently. When processing symbolic links to
+directories, there are two cases:
+1. When -L is not specified (the default): findfiles reproduces the behavior of
+   find (et al). A command line symbolic link target WITH a trailing slash ('/')
+   (eg, 'dirsymlink/') is followed, but when such a target has no trailing
+   slash (eg, 'dirsymlink') the symbolic link is NOT followed.
+2. When -L is specified: findfiles always follows all symbolic links.
+In the words of one of my old project managers at the Cupertino HP UNIX lab in
+1987, "standard is better than better". I still don't like it, though.
+*******************************************************************************/
+void trim_trailing_slashes(char *pathname) {
+    char	*chptr;
+    int		len;
+
+    len = strlen(pathname);
+    if (len > 1) {		/* handle the special case of '/' correctly */
+	chptr = pathname+len-1;
+	while (chptr >= pathname && *chptr == PATHDELIMITERCHAR) {
+	    *chptr-- = '\0';
+	}
+    }
+}
+
+
+/*******************************************************************************
+Convert *time_s_ptr to broken down local time in *timeinfoptr and return
+timeinfoptr (or NULL if it can't be converted) - like localtime_r. The result for
+the local day of the last time converted is kept in *cacheptr, so for times in the
+same day, only the time of day is calculated. A day is only cached if it's exactly
+SECONDSPERDAY long: days with DST (or UTC offset or leap second) transitions aren't.
+*******************************************************************************/
+struct tm *get_local_time(const time_t *time_s_ptr, struct tm *timeinfoptr, Localtimecache *cacheptr) {
+    struct tm	daystartinfo, dayendinfo;
+    time_t	secondofday, dayend_s;
+
+    if (cacheptr->validflag && *time_s_ptr >= cacheptr->daystart_s && *time_s_ptr-cacheptr->daystart_s < SECONDSPERDAY) {
+	secondofday = *time_s_ptr - cacheptr->daystart_s;
+	*timeinfoptr = cacheptr->daytimeinfo;
+	timeinfoptr->tm_hour = secondofday / SECONDSPERHOUR;
+	timeinfoptr->tm_min = secondofday / SECONDSPERMINUTE % MINUTESPERHOUR;
+	timeinfoptr->tm_sec = secondofday % SECONDSPERMINUTE;
+	return timeinfoptr;
+    }
+
+    if (localtime_r(time_s_ptr, timeinfoptr) == NULL) {
+	return NULL;
+    }
+    cacheptr->daystart_s = *time_s_ptr - (timeinfoptr->tm_hour*SECONDSPERHOUR + timeinfoptr->tm_min*SECONDSPERMINUTE + timeinfoptr->tm_sec);
+    dayend_s = cacheptr->daystart_s + SECONDSPERDAY-1;
+    cacheptr->daytimeinfo = *timeinfoptr;
+    cacheptr->validflag =
+	localtime_r(&cacheptr->daystart_s, &daystartinfo) != NULL && localtime_r(&dayend_s, &dayendinfo) != NULL &&
+	daystartinfo.tm_hour == 0 && daystartinfo.tm_min == 0 && daystartinfo.tm_sec == 0 &&
+	dayendinfo.tm_hour == HOURSPERDAY-1 && dayendinfo.tm_min == MINUTESPERHOUR-1 && dayendinfo.tm_sec == SECONDSPERMINUTE-1 &&
+	daystartinfo.tm_mday == timeinfoptr->tm_mday && dayendinfo.tm_mday == timeinfoptr->tm_mday &&
+	daystartinfo.tm_isdst == timeinfoptr->tm_isdst && dayendinfo.tm_isdst == timeinfoptr->tm_isdst;
+    return timeinfoptr;
+}
+
+
+/*******************************************************************************
+Write the contents of outputbuffer (to stdout).
+*******************************************************************************/
+void flush_output_buffer() {
+    if (outputlength > 0) {
+	fwrite(outputbuffer, 1, outputlength, stdout);
+	outputlength = 0;
+    }
+}
+
+
+/*******************************************************************************
+Return space for (at least) length more bytes at the end of outputbuffer.
+*******************************************************************************/
+char *get_output_space(size_t length) {
+    if (outputlength + length > OUTPUTBUFSIZE) {
+	flush_output_buffer();
+    }
+    return outputbuffer + outputlength;
+}
+
+
+/*******************************************************************************
+Append the first length characters of string to outputbuffer.
+*******************************************************************************/
+void append_output(const char *string, size_t length) {
+    if (length > OUTPUTBUFSIZE) {	/* can't happen in practice */
+	flush_output_buffer();
+	fwrite(string, 1, length, stdout);
+    } else {
+	memcpy(get_output_space(length), string, length);
+	outputlength += length;
+    }
+}
+
+
+/*******************************************************************************
+Append the output of printf(formatstr, ...) to outputbuffer. This is used for the
+formats that can be customized (eg, FF_DATETIMEFORMAT) and floating point values.
+*******************************************************************************/
+void append_formatted_output(const char *formatstr, ...) {
+    va_list	argptr;
+    int		length;
+
+    va_start(argptr, formatstr);
+    length = vsnprintf(get_output_space(0), OUTPUTBUFSIZE-outputlength, formatstr, argptr);
+    va_end(argptr);
+    if (length >= 0 && (size_t)length >= OUTPUTBUFSIZE-outputlength) {	/* it didn't fit */
+	flush_output_buffer();
+	va_start(argptr, formatstr);
+	if ((size_t)length < OUTPUTBUFSIZE) {
+	    length = vsnprintf(outputbuffer, OUTPUTBUFSIZE, formatstr, argptr);
+	} else {
+	    vprintf(formatstr, argptr);
+	    length = 0;
+	}
+	va_end(argptr);
+    }
+    if (length > 0) {
+	outputlength += length;
+    }
+}
+
+
+/*******************************************************************************
+Format value (right justified in width characters, padded with padchar - ' ' or
+'0') at buf, like printf's "%<width>ld" or "%0<width>ld". The result is not null
+terminated. Return its length. width must be less than MAXINTEGERLENGTH.
+*******************************************************************************/
+int format_integer(char *buf, long value, int width, char padchar) {
+    char		digitbuffer[MAXINTEGERLENGTH], *chptr = digitbuffer+MAXINTEGERLENGTH;
+    unsigned long	absvalue = value < 0 ? -(unsigned long)value : (unsigned long)value;
+    int			length;
+
+    do {
+	*--chptr = '0' + absvalue%10;
+	absvalue /= 10;
+    } while (absvalue > 0);
+    if (value < 0 && padchar == '0') {	/* eg, "-0042" */
+	while (digitbuffer+MAXINTEGERLENGTH-chptr < width-1) {
+	    *--chptr = padchar;
+	}
+    }
+    if (value < 0) {
+	*--chptr = NEGATIVESIGNCHAR;
+    }
+    while (digitbuffer+MAXINTEGERLENGTH-chptr < width) {
+	*--chptr = padchar;
+    }
+    length = digitbuffer+MAXINTEGERLENGTH-chptr;
+    memcpy(buf, chptr, length);
+    return length;
+}
+
+
+/*******************************************************************************
+Append value to outputbuffer (see format_integer).
+*******************************************************************************/
+void append_integer(long value, int width, char padchar) {
+    outputlength += format_integer(get_output_space(MAXINTEGERLENGTH), value, width, padchar);
+}
+
+
+/*******************************************************************************
+Very large numbers can be difficult to read - especially when they have no
+thousands separators. This function displays object sizes with a suitably scaled
+decimal part (a "mantissa" of sorts) and a suitable unit (eg, "GiB").  For
+example, an object of size 1000000000B is displayed as "1.00MB" or "954MiB".
+*******************************************************************************/
+#define TENLIMIT	9.9999	/* Prevent printf rounding issues with 10 */
+#define HUNDREDLIMIT	99.999	/* Prevent printf rounding issues with 100 */
+
+void display_human_readable_size(size_t size) {
+    float mantissa;
+    size_t unitidx, divisor = 1;
+
+    /* Loop from index 0 to (max) N-2. That is, max N-1 interations! */
+    for (unitidx=0; unitidx<numhumanunits-1; unitidx++) {
+	if (size < humanunittable[unitidx].sizelimit) {
+	    break;
+	} else {
+	    divisor = humanunittable[unitidx].sizelimit;
+	}
+    }
+    /* Use the largest unit's details even if the file size exceeds its sizelimit */
+    mantissa = size / (float)divisor;
+
+    if (mantissa < TENLIMIT) {
+	append_formatted_output(" %4.2f%s  ", mantissa, humanunittable[unitidx].unitstring);
+    } else if (mantissa < HUNDREDLIMIT) {
+	append_formatted_output(" %4.1f%s  ", mantissa, humanunittable[unitidx].unitstring);
+    } else {
+	append_formatted_output(" %4.0f%s  ", mantissa, humanunittable[unitidx].unitstring);
+    }
+}
+
+
+/*******************************************************************************
+Process a (file system) object (a file, directory or "other" object) called name
+in the open directory dirfiledes, whose pathname is dirpathname. Command line
+targets are called with dirfiledes AT_FDCWD, dirpathname NULL and direnttype
+DT_UNKNOWN. When the type of the directory entry (direnttype) is known, the
+object is not stat'ed here, nor is it when process_directory has already stat'ed
+it (in a batch with io_uring) - then prefetchedptr points to its information,
+and namematch is the result of matching its name (see process_object).
+When more than one thread is used (-j), a command line target directory is handed
+to the tree traversal threads, and those threads queue the subdirectories they
+find (workerptr is not NULL) instead of recursing into them.
+*******************************************************************************/
+void process_path(int dirfiledes, const char *dirpathname, char *name, unsigned char direnttype,
+			int recursiondepth, Workerinfo *workerptr, const Objectinfo *prefetchedptr, int namematch) {
+    Objectinfo		statinfo;
+    const Objectinfo	*statinfoptr = NULL;
+    Watchdirectory	*watchdirptr;
+    struct stat		targetinfo;
+    char		pathname[MAXPATHLENGTH];
+    mode_t		type;
+    dev_t		device = 0;
+    int			targetfoundflag = 0, loopflag = 0;
+
+    if (!regularfileflag && !directoryflag && !otherobjectflag) {
+	fprintf(stderr, "W: Please choose at least one object type (-f, -d or -o) for '%s'!\n", name);
+	set_shared_flag(&returncode);
+	return;
+    }
+
+    if (recursiondepth == 0) {
+	plan_object_stats();
+    }
+
+    if (prefetchedptr != NULL) {	/* already stat'ed (in a batch) by process_directory */
+	type = prefetchedptr->type;
+	statinfoptr = prefetchedptr;
+    } else if (direnttype != DT_UNKNOWN) {
+	type = DTTOIF(direnttype);
+    } else if (stat_object(dirfiledes, name, objectstatmask, timeinfochar, &statinfo) == -1) {
+	fprintf(stderr, "W: process_path: Cannot access '%s'\n", build_pathname(pathname, dirpathname, name));
+	set_shared_flag(&returncode);
+	return;
+    } else {
+	type = statinfo.type;
+	statinfoptr = &statinfo;
+    }
+
+    if (S_ISREG(type)) {		/* process a "regular" file */
+	if (regularfileflag) {
+	    process_object(dirfiledes, dirpathname, name, type, statinfoptr, workerptr, namematch);
+	}
+    /* process a directory or symlink to a directory if followsymlinksflag is set */
+    } else if (S_ISDIR(type) || (S_ISLNK(type) && followsymlinksflag)) {
+	if (recursiondepth == 0) {
+	   trim_trailing_slashes(name);
+	}
+	/* -L & -Z: what a symbolic link points to (it's not followed if that's not a directory), and its identity */
+	if (S_ISLNK(type) || uniqueflag) {
+	    targetfoundflag = fstatat(dirfiledes, name, &targetinfo, 0) == 0;
+	    if (targetfoundflag && S_ISLNK(type) && S_ISDIR(targetinfo.st_mode)) {
+		loopflag = check_symlink_loop(dirpathname, name, &targetinfo, workerptr);
+	    }
+	    if (uniqueflag && targetfoundflag && !insert_unique_object(targetinfo.st_dev, targetinfo.st_ino)) {
+		return;		/* already found through another path */
+	    }
+	}
+	if (directoryflag) {
+	    process_object(dirfiledes, dirpathname, name, type, statinfoptr, workerptr, namematch);
+	}
+
+	/* Is this a command line argument (directory or symlink/) AND maxrecursiondepth > 0 */
+	if (recursiondepth == 0 && maxrecursiondepth > 0) {
+	    if (devicecheckflag) {
+		set_target_device(name);
+	    }
+	    if (watchhashtable != NULL && !followsymlinksflag && !uniqueflag &&
+		    (watchdirptr=find_watched_directory(name)) != NULL) {
+		process_watched_directory(watchdirptr, name);
+	    } else if (indexfilename != NULL) {
+		process_target_with_index(name);
+	    } else if (numthreads > 1 && !uniqueflag) {	/* (-Z: which path is found first must not depend on the threads) */
+		traverse_directory_in_parallel(name);
+	    } else {
+		traverse_directory(name, recursiondepth);
+	    }
+	} else if (recursiveflag && !loopflag && (!S_ISLNK(type) || !targetfoundflag || S_ISDIR(targetinfo.st_mode)) &&
+		(numprunes == 0 || !prune_directory(name)) &&
+		(!devicecheckflag || (statinfoptr != NULL && S_ISDIR(type) ?	/* (already stat'ed, and not a symlink) */
+		    check_device(device=statinfoptr->device) : check_directory_device(dirfiledes, name, &device)))) {
+	    /* Parent directories are not kept open (see traverse_directory): no file descriptor limit */
+	    build_pathname(pathname, dirpathname, name);
+	    if (recursiondepth >= maxrecursiondepth) {
+		fprintf(stderr, "W: Cannot traverse directory '%s' (depth %d)\n", pathname, recursiondepth);
+		fprintf(stderr, "W: Maximum tree traversal depth is %d\n", maxrecursiondepth);
+	    } else if (check_pathname_length(pathname, recursiondepth)) {
+		if (workerptr != NULL) {
+		    push_directory(workerptr, pathname, recursiondepth, device);
+		} else {
+		    stack_directory(pathname, recursiondepth);
+		}
+	    }
+	}
+    } else if (otherobjectflag) {		/* process "other" object types */
+	process_object(dirfiledes, dirpathname, name, type, statinfoptr, workerptr, namematch);
+    }
+}
+
+
+/*******************************************************************************
+Set the size of the buffers that directories are read into (FF_DIRBUFSIZE).
+Any buffer allocated with the previous size is freed.
+*******************************************************************************/
+void set_directory_buffer_size() {
+    char	*endptr;
+    long	size;
+
+    size = strtol(dirbuffersizestr, &endptr, 10);
+    if (*dirbuffersizestr == '\0' || *endptr != '\0' || size < MINDIRBUFSIZE || size > MAXDIRBUFSIZE) {
+	fprintf(stderr, "E: Illegal %s value '%s' (must be %d to %d)\n", FF_DIRBUFSIZESTR, dirbuffersizestr,
+	    MINDIRBUFSIZE, MAXDIRBUFSIZE);
+	exit(1);
+    }
+    dirbuffersize = size;
+
+    free(maindirbuffer);
+    maindirbuffer = NULL;
+}
+
+
+/*******************************************************************************
+Set the minimum number of objects to sort with several threads (FF_PARALLELSORT).
+*******************************************************************************/
+void set_parallel_sort_minimum() {
+    char	*endptr;
+
+    parallelsortminimum = strtol(parallelsortstr, &endptr, 10);
+    if (*parallelsortstr == '\0' || *endptr != '\0' || parallelsortminimum < 1) {
+	fprintf(stderr, "E: Illegal %s value '%s' (must be > 0)\n", FF_PARALLELSORTSTR, parallelsortstr);
+	exit(1);
+    }
+}
+
+
+/*******************************************************************************
+Return a buffer to read a directory into. Directories are read one at a time (see
+traverse_directory), so one buffer - or one per tree traversal thread - is
+enough. It is allocated when first needed and reused.
+*******************************************************************************/
+char *get_directory_buffer(Workerinfo *workerptr) {
+    if (workerptr != NULL) {
+	return workerptr->dirbuffer;
+    }
+
+    if (maindirbuffer == NULL && (maindirbuffer=malloc(dirbuffersize)) == NULL) {
+	perror("E: insufficient memory - malloc failed");
+	exit(1);
+    }
+    return maindirbuffer;
+}
+
+
+#if HAVEIOURING
+/*******************************************************************************
+Unmap the rings of the io_uring instance *uringptr and close it.
+*******************************************************************************/
+void close_uring(Uringinfo *uringptr) {
+    if (uringptr->ringfiledes != -1) {
+	munmap(uringptr->sqes, uringptr->sqessize);
+	if (uringptr->cqringptr != uringptr->sqringptr) {
+	    munmap(uringptr->cqringptr, uringptr->cqringsize);
+	}
+	munmap(uringptr->sqringptr, uringptr->sqringsize);
+	close(uringptr->ringfiledes);
+	uringptr->ringfiledes = -1;
+    }
+}
+
+
+/*******************************************************************************
+Return the io_uring instance to stat objects with: the single threaded traversal
+has one, and so does each tree traversal thread. It is set up (with uringqueuedepth
+entries) when first used, and again if -q has been changed since. Return NULL if
+io_uring is not used (-q 0) or if it cannot be set up (eg, on kernels before 5.6
+or when it is disabled), in which case the objects are stat'ed one at a time.
+*******************************************************************************/
+Uringinfo *get_uring(Workerinfo *workerptr) {
+    struct io_uring_params	params;
+    Uringinfo			*uringptr = workerptr == NULL ? &mainuring : &workerptr->uring;
+    char			*sqringptr, *cqringptr;
+
+    if (uringqueuedepth == 0 || __atomic_load_n(&uringwarningflag, __ATOMIC_RELAXED)) {
+	return NULL;
+    }
+    if (uringptr->ringfiledes != -1) {
+	if (uringptr->numentries == (unsigned)uringqueuedepth) {
+	    return uringptr;
+	}
+	close_uring(uringptr);
+    }
+
+    memset(&params, 0, sizeof(params));
+    if ((uringptr->ringfiledes=syscall(__NR_io_uring_setup, uringqueuedepth, &params)) == -1) {
+	if (!set_shared_flag(&uringwarningflag)) {
+	    fprintf(stderr, "W: io_uring is not available (%s), using statx instead\n", strerror(errno));
+	}
+	return NULL;
+    }
+
+    uringptr->sqringsize = params.sq_off.array + params.sq_entries*sizeof(unsigned);
+    uringptr->cqringsize = params.cq_off.cqes + params.cq_entries*sizeof(struct io_uring_cqe);
+    uringptr->sqessize = params.sq_entries*sizeof(struct io_uring_sqe);
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) && uringptr->cqringsize > uringptr->sqringsize) {
+	uringptr->sqringsize = uringptr->cqringsize;
+    }
+    sqringptr = mmap(NULL, uringptr->sqringsize, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE,
+						uringptr->ringfiledes, IORING_OFF_SQ_RING);
+    if (sqringptr == MAP_FAILED) {
+	perror("E: Could not mmap io_uring submission queue");
+	exit(1);
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+	cqringptr = sqringptr;
+    } else if ((cqringptr=mmap(NULL, uringptr->cqringsize, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE,
+						uringptr->ringfiledes, IORING_OFF_CQ_RING)) == MAP_FAILED) {
+	perror("E: Could not mmap io_uring completion queue");
+	exit(1);
+    }
+    if ((uringptr->sqes=mmap(NULL, uringptr->sqessize, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE,
+						uringptr->ringfiledes, IORING_OFF_SQES)) == MAP_FAILED) {
+	perror("E: Could not mmap io_uring submission queue entries");
+	exit(1);
+    }
+
+    uringptr->sqringptr = sqringptr;
+    uringptr->cqringptr = cqringptr;
+    uringptr->numentries = params.sq_entries < (unsigned)uringqueuedepth ? params.sq_entries : (unsigned)uringqueuedepth;
+    uringptr->sqtailptr = (unsigned *)(sqringptr + params.sq_off.tail);
+    uringptr->sqmaskptr = (unsigned *)(sqringptr + params.sq_off.ring_mask);
+    uringptr->sqarray   = (unsigned *)(sqringptr + params.sq_off.array);
+    uringptr->cqheadptr = (unsigned *)(cqringptr + params.cq_off.head);
+    uringptr->cqtailptr = (unsigned *)(cqringptr + params.cq_off.tail);
+    uringptr->cqmaskptr = (unsigned *)(cqringptr + params.cq_off.ring_mask);
+    uringptr->cqes = (struct io_uring_cqe *)(cqringptr + params.cq_off.cqes);
+    return uringptr;
+}
+
+
+/*******************************************************************************
+Does directory entry name (of type direnttype) need to be stat'ed? It does if its
+type is unknown, or if process_object will select it (by type and name) and needs
+more than its type. This mirrors the checks in process_path & process_object. If
+the name is matched, *namematchptr is set to the result (so process_object does
+not match it again), otherwise to NAMEMATCHUNKNOWN.
+*******************************************************************************/
+int entry_needs_stat(const char *name, unsigned char direnttype, int *namematchptr) {
+    mode_t	type;
+
+    *namematchptr = NAMEMATCHUNKNOWN;
+    if (direnttype == DT_UNKNOWN) {
+	return 1;
+    }
+    if (objectstatmask == STATX_TYPE) {
+	return 0;
+    }
+    type = DTTOIF(direnttype);
+    if (S_ISREG(type)) {
+	return regularfileflag && (*namematchptr=match_object_name(name));
+    } else if (S_ISDIR(type) || (S_ISLNK(type) && followsymlinksflag)) {
+	return directoryflag && (*namematchptr=match_object_name(name));
+    }
+    return otherobjectflag && (*namematchptr=match_object_name(name));
+}
+
+
+/*******************************************************************************
+Stat the numentries entries of batchtable whose statresult is STATPENDING (they
+are in the open directory dirfiledes) with io_uring: queue one statx request for
+each, submit them all and wait for them all to complete with one system call (or
+a few, if interrupted). The entries that were stat'ed successfully have their
+information converted; the others are stat'ed again later (one at a time) by
+process_path or process_object - which issue the usual warning if need be.
+*******************************************************************************/
+void stat_batch_with_uring(Uringinfo *uringptr, int dirfiledes, Batchentry *batchtable, int numentries) {
+    struct io_uring_sqe	*sqeptr;
+    struct io_uring_cqe	*cqeptr;
+    unsigned		sqtail, cqhead, numqueued = 0, numsubmitted = 0, numcompleted = 0;
+    long		result;
+    int			idx;
+
+    sqtail = *uringptr->sqtailptr;
+    for (idx=0; idx<numentries; idx++) {
+	if (batchtable[idx].statresult == STATPENDING) {
+	    sqeptr = &uringptr->sqes[sqtail & *uringptr->sqmaskptr];
+	    memset(sqeptr, 0, sizeof(*sqeptr));
+	    sqeptr->opcode = IORING_OP_STATX;
+	    sqeptr->fd = dirfiledes;
+	    sqeptr->addr = (uintptr_t)batchtable[idx].name;
+	    sqeptr->len = objectstatmask;
+	    sqeptr->off = (uintptr_t)&batchtable[idx].statxinfo;
+	    sqeptr->statx_flags = AT_SYMLINK_NOFOLLOW|AT_NO_AUTOMOUNT|(nosyncflag ? AT_STATX_DONT_SYNC : AT_STATX_SYNC_AS_STAT);
+	    sqeptr->user_data = idx;
+	    uringptr->sqarray[sqtail & *uringptr->sqmaskptr] = sqtail & *uringptr->sqmaskptr;
+	    sqtail++;
+	    numqueued++;
+	}
+    }
+    if (numqueued == 0) {
+	return;
+    }
+    __atomic_store_n(uringptr->sqtailptr, sqtail, __ATOMIC_RELEASE);
+
+    while (numcompleted < numqueued) {
+	if ((result=syscall(__NR_io_uring_enter, uringptr->ringfiledes, numqueued-numsubmitted,
+			numqueued-numcompleted, IORING_ENTER_GETEVENTS, NULL, 0)) == -1) {
+	    if (errno == EINTR) {
+		continue;
+	    }
+	    /* The kernel may still be writing to batchtable: this cannot be recovered from */
+	    perror("E: io_uring_enter failed");
+	    exit(1);
+	}
+	numsubmitted += result;
+
+	cqhead = *uringptr->cqheadptr;
+	while (cqhead != __atomic_load_n(uringptr->cqtailptr, __ATOMIC_ACQUIRE)) {
+	    cqeptr = &uringptr->cqes[cqhead & *uringptr->cqmaskptr];
+	    batchtable[cqeptr->user_data].statresult = cqeptr->res;
+	    if (cqeptr->res == -EINVAL && !set_shared_flag(&uringwarningflag)) {	/* eg, IORING_OP_STATX is not supported */
+		fprintf(stderr, "W: io_uring statx is not available, using statx instead\n");
+	    }
+	    cqhead++;
+	    numcompleted++;
+	}
+	__atomic_store_n(uringptr->cqheadptr, cqhead, __ATOMIC_RELEASE);
+    }
+
+    for (idx=0; idx<numentries; idx++) {
+	if (batchtable[idx].statresult == 0) {
+	    convert_statx_info(&batchtable[idx].statxinfo, objectstatmask, timeinfochar, &batchtable[idx].objectinfo);
+	}
+    }
+}
+
+
+/*******************************************************************************
+Process the numbytesread bytes of directory entries in dirbuffer (read from the
+open directory dirfiledes, whose pathname is pathname) in batches of up to queue
+depth (-q) entries. The entries in each batch that need to be stat'ed are stat'ed
+together with io_uring before any of them are processed.
+*******************************************************************************/
+void process_directory_entries_in_batches(Uringinfo *uringptr, int dirfiledes, char *pathname, char *dirbuffer,
+				long numbytesread, Batchentry *batchtable, int recursiondepth, Workerinfo *workerptr) {
+    struct dirent64	*direntptr;
+    long		offset = 0;
+    int			idx, numentries;
+
+    while (offset < numbytesread) {
+	for (numentries=0; offset<numbytesread && numentries<(int)uringptr->numentries; offset+=direntptr->d_reclen) {
+	    direntptr = (struct dirent64 *)(dirbuffer+offset);
+	    if (!ISDOTORDOTDOT(direntptr->d_name)) {
+		batchtable[numentries].name = direntptr->d_name;
+		batchtable[numentries].direnttype = direntptr->d_type;
+		batchtable[numentries].statresult = entry_needs_stat(direntptr->d_name, direntptr->d_type,
+						&batchtable[numentries].namematch) ? STATPENDING : STATNOTNEEDED;
+		numentries++;
+	    }
+	}
+
+	stat_batch_with_uring(uringptr, dirfiledes, batchtable, numentries);
+	for (idx=0; idx<numentries; idx++) {
+	    process_path(dirfiledes, pathname, batchtable[idx].name, batchtable[idx].direnttype, recursiondepth+1,
+		workerptr, batchtable[idx].statresult == 0 ? &batchtable[idx].objectinfo : NULL, batchtable[idx].namematch);
+	}
+    }
+}
+#endif
+
+
+/*******************************************************************************
+-L: link the directory being read (open as dirfiledes) to the one it was found
+in, and make it the directory being read (see Dirnode).
+*******************************************************************************/
+void enter_directory(int dirfiledes, Workerinfo *workerptr) {
+    Dirnode	**currentptrptr = workerptr == NULL ? &currentdirnodeptr : &workerptr->dirnodeptr;
+    Dirnode	**allocatedptrptr = workerptr == NULL ? &allocateddirnodes : &workerptr->allocateddirnodes;
+    Dirnode	*dirnodeptr;
+    struct stat	statinfo;
+
+    if ((dirnodeptr=(Dirnode*)malloc(sizeof(Dirnode))) == NULL) {
+	perror("E: insufficient memory - malloc failed");
+	exit(1);
+    }
+    dirnodeptr->nextallocatedptr = *allocatedptrptr;
+    *allocatedptrptr = dirnodeptr;
+    if (fstat(dirfiledes, &statinfo) == -1) {
+	statinfo.st_dev = 0;
+	statinfo.st_ino = 0;
+    }
+    dirnodeptr->device = statinfo.st_dev;
+    dirnodeptr->inode = statinfo.st_ino;
+    dirnodeptr->parentptr = *currentptrptr;
+    *currentptrptr = dirnodeptr;
+}
+
+
+/*******************************************************************************
+-L: the directory being read has been read: go back to the one it was found in.
+*******************************************************************************/
+void leave_directory(Workerinfo *workerptr) {
+    Dirnode	**currentptrptr = workerptr == NULL ? &currentdirnodeptr : &workerptr->dirnodeptr;
+
+    *currentptrptr = (*currentptrptr)->parentptr;
+}
+
+
+/*******************************************************************************
+-L: return 1 (with a warning) if the symbolic link name, in the directory being
+read (dirpathname), points to that directory or one it was found in, ie,
+*targetinfoptr is one of them. Following it would loop (to the maximum depth).
+Otherwise return 0.
+*******************************************************************************/
+int check_symlink_loop(const char *dirpathname, const char *name, const struct stat *targetinfoptr,
+										const Workerinfo *workerptr) {
+    const Dirnode	*dirnodeptr;
+    char		pathname[MAXPATHLENGTH];
+
+    for (dirnodeptr=(workerptr == NULL ? currentdirnodeptr : workerptr->dirnodeptr); dirnodeptr != NULL;
+									dirnodeptr=dirnodeptr->parentptr) {
+	if (dirnodeptr->inode == targetinfoptr->st_ino && dirnodeptr->device == targetinfoptr->st_dev) {
+	    fprintf(stderr, "W: Not following symbolic link loop '%s'\n", build_pathname(pathname, dirpathname, name));
+	    set_shared_flag(&returncode);
+	    return 1;
+	}
+    }
+    return 0;
+}
+
+
+/*******************************************************************************
+-Z/--unique: add the object identified by device & inode to uniquetable. Return
+1 if it was added, or 0 if it was already there (found through another path, or
+it's a hard link to an object already found).
+*******************************************************************************/
+int insert_unique_object(dev_t device, ino_t inode) {
+    Objectid	*oldtable;
+    size_t	oldtablesize, idx, hashidx;
+
+    pthread_mutex_lock(&uniquelock);
+    if (2*(numuniqueobjects+1) > uniquetablesize) {	/* keep it at most half full */
+	oldtable = uniquetable;
+	oldtablesize = uniquetablesize;
+	uniquetablesize = uniquetablesize > 0 ? uniquetablesize * 2 : INITUNIQUETABLESIZE;
+	if ((uniquetable=(Objectid*)calloc(uniquetablesize, sizeof(Objectid))) == NULL) {
+	    perror("E: insufficient memory - calloc failed");
+	    exit(1);
+	}
+	for (idx=0; idx<oldtablesize; idx++) {
+	    if (oldtable[idx].inode != 0 || oldtable[idx].device != 0) {
+		hashidx = hash_object_id(oldtable[idx].device, oldtable[idx].inode);
+		while (uniquetable[hashidx].inode != 0 || uniquetable[hashidx].device != 0) {
+		    hashidx = (hashidx+1) & (uniquetablesize-1);
+		}
+		uniquetable[hashidx] = oldtable[idx];
+	    }
+	}
+	free(oldtable);
+    }
+
+    hashidx = hash_object_id(device, inode);
+    while (uniquetable[hashidx].inode != 0 || uniquetable[hashidx].device != 0) {
+	if (uniquetable[hashidx].inode == inode && uniquetable[hashidx].device == device) {
+	    pthread_mutex_unlock(&uniquelock);
+	    return 0;
+	}
+	hashidx = (hashidx+1) & (uniquetablesize-1);
+    }
+    uniquetable[hashidx].device = device;
+    uniquetable[hashidx].inode = inode;
+    numuniqueobjects++;
+    pthread_mutex_unlock(&uniquelock);
+    return 1;
+}
+
+
+/*******************************************************************************
+-Z/--unique: return the uniquetable index to start looking for device & inode at.
+*******************************************************************************/
+size_t hash_object_id(dev_t device, ino_t inode) {
+    return (size_t)((((unsigned long long)inode ^ ((unsigned long long)device << 17)) * 0x9E3779B97F4A7C15ULL) >> 24) &
+										(uniquetablesize-1);
+}
+
+
+/*******************************************************************************
+Process a directory (pathname), which is called name in the open directory
+parentdirfiledes. Open it, read all it's entries (objects) and call process_path
+for each one (EXCEPT '.' and '..') and close it. The entries are accessed by
+name relative to this directory's file descriptor, so the OS doesn't have to
+look up every component of their pathnames again. On Linux, the entries are
+read with getdents64 into a large buffer (many at a time) and used in place, and
+with -q, those that need to be stat'ed are stat'ed in batches with io_uring.
+*******************************************************************************/
+void process_directory(int parentdirfiledes, char *pathname, const char *name, int recursiondepth, Workerinfo *workerptr) {
+#if HAVEGETDENTS64
+    struct dirent64	*direntptr;
+    char		*dirbuffer;
+    long		numbytesread, offset;
+    int			dirfiledes;
+#if HAVEIOURING
+    Uringinfo		*uringptr;
+    Batchentry		*batchtable = NULL;
+#endif
+
+    if ((dirfiledes=openat(parentdirfiledes, name, O_RDONLY|O_DIRECTORY)) == -1) {
+	fprintf(stderr, "W: opendir error - ");
+	perror(pathname);
+	set_shared_flag(&returncode);
+	return;
+    }
+    if (followsymlinksflag) {
+	enter_directory(dirfiledes, workerptr);
+    }
+
+    dirbuffer = get_directory_buffer(workerptr);
+#if HAVEIOURING
+    if ((uringptr=get_uring(workerptr)) != NULL &&
+		(batchtable=malloc(uringptr->numentries*sizeof(Batchentry))) == NULL) {
+	perror("E: insufficient memory - malloc failed");
+	exit(1);
+    }
+#endif
+    while ((numbytesread=syscall(SYS_getdents64, dirfiledes, dirbuffer, dirbuffersize)) > 0) {
+#if HAVEIOURING
+	if (batchtable != NULL) {
+	    process_directory_entries_in_batches(uringptr, dirfiledes, pathname, dirbuffer, numbytesread,
+							batchtable, recursiondepth, workerptr);
+	    continue;
+	}
+#endif
+	for (offset=0; offset<numbytesread; offset+=direntptr->d_reclen) {
+	    direntptr = (struct dirent64 *)(dirbuffer+offset);
+	    if (!ISDOTORDOTDOT(direntptr->d_name)) {
+		process_path(dirfiledes, pathname, direntptr->d_name, direntptr->d_type, recursiondepth+1, workerptr, NULL,
+											NAMEMATCHUNKNOWN);
+	    }
+	}
+    }
+    if (numbytesread == -1) {
+	fprintf(stderr, "W: getdents64 error - ");
+	perror(pathname);
+	set_shared_flag(&returncode);
+    }
+#if HAVEIOURING
+    free(batchtable);
+#endif
+    if (followsymlinksflag) {
+	leave_directory(workerptr);
+    }
+
+    if (close(dirfiledes)) {
+	perror(pathname);
+	set_shared_flag(&returncode);
+    }
+#else
+    DIR			*dirptr;
+    struct dirent	*direntptr;
+    int			dirfiledes;
+
+    if ((dirfiledes=openat(parentdirfiledes, name, O_RDONLY|O_DIRECTORY)) == -1 || (dirptr=fdopendir(dirfiledes)) == (DIR*)NULL) {
+	fprintf(stderr, "W: opendir error - ");
+	perror(pathname);
+	if (dirfiledes != -1) {
+	    close(dirfiledes);
+	}
+	set_shared_flag(&returncode);
+	return;
+    }
+    if (followsymlinksflag) {
+	enter_directory(dirfiledes, workerptr);
+    }
+
+    while ((direntptr=readdir(dirptr)) != (struct dirent *)NULL) {
+	if (!ISDOTORDOTDOT(direntptr->d_name)) {
+	    process_path(dirfiledes, pathname, direntptr->d_name, DIRENTTYPE(direntptr), recursiondepth+1, workerptr, NULL,
+											NAMEMATCHUNKNOWN);
+	}
+    }
+    if (followsymlinksflag) {
+	leave_directory(workerptr);
+    }
+
+    if (closedir(dirptr)) {
+	perror(pathname);
+	set_shared_flag(&returncode);
+    }
+#endif
+}
+
+
+/*******************************************************************************
+Push a directory (a copy of pathname) to be read at recursiondepth onto dirstack
+(see traverse_directory), and return it (until the next push). If dirstack is
+full, its size is dynamically increased.
+*******************************************************************************/
+Diritem *stack_directory(const char *pathname, int recursiondepth) {
+    Diritem	*olddirstack;
+    char	*pathnamecopy;
+
+    if ((pathnamecopy=malloc(strlen(pathname)+1)) == NULL) {
+	perror("E: insufficient memory - malloc failed");
+	exit(1);
+    }
+    strcpy(pathnamecopy, pathname);
+
+    if (numstackeddirs >= dirstacksize) {
+	dirstacksize = dirstacksize > 0 ? dirstacksize * 2 : INITDIRDEQUESIZE;
+	olddirstack = dirstack;
+	if ((dirstack=realloc(dirstack, dirstacksize*sizeof(Diritem))) == NULL) {
+	    perror("E: insufficient memory - realloc failed");
+	    free(olddirstack);		/* Only here to make Cppcheck happy */
+	    exit(1);
+	}
+    }
+    dirstack[numstackeddirs].pathname = pathnamecopy;
+    dirstack[numstackeddirs].recursiondepth = recursiondepth;
+    dirstack[numstackeddirs].parentnodeptr = currentdirnodeptr;
+    dirstack[numstackeddirs].mtime_s = dirstack[numstackeddirs].mtime_ns = 0;
+    dirstack[numstackeddirs].watchdirptr = NULL;
+    return &dirstack[numstackeddirs++];
+}
+
+
+/*******************************************************************************
+Reverse the directories pushed onto dirstack from firstidx on (the subdirectories
+of the directory just read), so they're popped in the order they were found: so
+the directories are read in the same order as by recursion (as are any warnings).
+*******************************************************************************/
+void reverse_stacked_directories(int firstidx) {
+    Diritem	diritem;
+    int		lastidx;
+
+    for (lastidx=numstackeddirs-1; firstidx<lastidx; firstidx++, lastidx--) {
+	diritem = dirstack[firstidx];
+	dirstack[firstidx] = dirstack[lastidx];
+	dirstack[lastidx] = diritem;
+    }
+}
+
+
+/*******************************************************************************
+Traverse the tree below the directory pathname (at recursiondepth) with one
+thread. Instead of recursing into each subdirectory as it's found, process_path
+pushes it onto dirstack (on the heap), and the directories are popped and read
+here, one at a time. So only one directory is open at a time, and the depth of
+the tree is limited by neither the file descriptor limit nor the stack size (but
+directories are opened by pathname, so these must fit in MAXPATHLENGTH). The
+directories are read in the same order as with recursion, and the objects are
+the same (only their order differs, with -O).
+*******************************************************************************/
+void traverse_directory(char *pathname, int recursiondepth) {
+    Diritem	diritem;
+    Dirnode	*dirnodeptr;
+    int		basenumstackeddirs = numstackeddirs, firstsubdiridx;
+
+    stack_directory(pathname, recursiondepth);
+    while (numstackeddirs > basenumstackeddirs) {
+	diritem = dirstack[--numstackeddirs];
+	firstsubdiridx = numstackeddirs;
+	currentdirnodeptr = diritem.parentnodeptr;
+	process_directory(AT_FDCWD, diritem.pathname, diritem.pathname, diritem.recursiondepth, NULL);
+	reverse_stacked_directories(firstsubdiridx);
+	free(diritem.pathname);
+    }
+
+    if (basenumstackeddirs == 0) {
+	currentdirnodeptr = NULL;
+	while ((dirnodeptr=allocateddirnodes) != NULL) {
+	    allocateddirnodes = dirnodeptr->nextallocatedptr;
+	    free(dirnodeptr);
+	}
+    }
+}
+
+
+/*******************************************************************************
+Queue a directory (a copy of pathname) at the tail of a tree traversal thread's
+deque. If the deque is full, its size is dynamically increased.
+*******************************************************************************/
+void push_directory(Workerinfo *workerptr, const char *pathname, int recursiondepth, dev_t device) {
+    Diritem	*olddirdeque;
+    char	*pathnamecopy;
+
+    if ((pathnamecopy=malloc(strlen(pathname)+1)) == NULL) {
+	perror("E: insufficient memory - malloc failed");
+	exit(1);
+    }
+    strcpy(pathnamecopy, pathname);
+
+    pthread_mutex_lock(&workerptr->dequelock);
+    if (workerptr->dequetail >= workerptr->dequesize) {
+	if (workerptr->dequehead > 0) {		/* reuse the space of the directories already stolen */
+	    memmove(workerptr->dirdeque, workerptr->dirdeque+workerptr->dequehead,
+		(workerptr->dequetail-workerptr->dequehead)*sizeof(Diritem));
+	    workerptr->dequetail -= workerptr->dequehead;
+	    workerptr->dequehead = 0;
+	}
+	if (workerptr->dequetail >= workerptr->dequesize) {
+	    workerptr->dequesize *= 2;
+	    olddirdeque = workerptr->dirdeque;
+	    if ((workerptr->dirdeque=realloc(workerptr->dirdeque, workerptr->dequesize*sizeof(Diritem))) == NULL) {
+		perror("E: insufficient memory - realloc failed");
+		free(olddirdeque);		/* Only here to make Cppcheck happy */
+		exit(1);
+	    }
+	}
+    }
+    workerptr->dirdeque[workerptr->dequetail].pathname = pathnamecopy;
+    workerptr->dirdeque[workerptr->dequetail].recursiondepth = recursiondepth;
+    workerptr->dirdeque[workerptr->dequetail].device = device;
+    workerptr->dirdeque[workerptr->dequetail].parentnodeptr = workerptr->dirnodeptr;
+    workerptr->dequetail++;
+    pthread_mutex_unlock(&workerptr->dequelock);
+
+    pthread_mutex_lock(&pendingdirslock);
+    numpendingdirs++;
+    numdirspushed++;
+    pthread_cond_signal(&pendingdirscond);
+    pthread_mutex_unlock(&pendingdirslock);
+}
+
+
+/*******************************************************************************
+-J: with pendingdirslock held, start reading a directory on device if fewer than
+maxdevicethreads threads are reading directories on it. Return 1 if so, else 0.
+*******************************************************************************/
+int acquire_device_slot(dev_t device) {
+    Deviceslot	*slotptr;
+
+    for (slotptr=deviceslottable; slotptr<deviceslottable+numdeviceslots && slotptr->device != device; slotptr++) {
+	;
+    }
+    if (slotptr == deviceslottable+numdeviceslots) {
+	if (numdeviceslots >= maxdeviceslots) {
+	    maxdeviceslots = maxdeviceslots > 0 ? maxdeviceslots * 2 : MAXNUMTHREADS;
+	    if ((deviceslottable=(Deviceslot*)realloc(deviceslottable, maxdeviceslots*sizeof(Deviceslot))) == NULL) {
+		perror("E: insufficient memory - realloc failed");
+		exit(1);
+	    }
+	    slotptr = deviceslottable+numdeviceslots;
+	}
+	slotptr->device = device;
+	slotptr->numthreads = 0;
+	numdeviceslots++;
+    }
+    if (slotptr->numthreads >= maxdevicethreads) {
+	return 0;
+    }
+    slotptr->numthreads++;
+    return 1;
+}
+
+
+/*******************************************************************************
+-J: with pendingdirslock held, finish reading a directory on device.
+*******************************************************************************/
+void release_device_slot(dev_t device) {
+    Deviceslot	*slotptr;
+
+    for (slotptr=deviceslottable; slotptr->device != device; slotptr++) {
+	;
+    }
+    slotptr->numthreads--;
+    numdeviceslotsfreed++;
+}
+
+
+/*******************************************************************************
+-J: with the deque's lock held, take the first directory (from the tail for the
+owner, or the head when stealing) whose device has a free slot (see
+acquire_device_slot). Return 0 if there isn't one.
+*******************************************************************************/
+int pop_directory_on_free_device(Workerinfo *workerptr, Diritem *diritemptr, int stealflag) {
+    int		idx, foundflag = 0;
+
+    pthread_mutex_lock(&pendingdirslock);
+    if (stealflag) {
+	for (idx=workerptr->dequehead; idx<workerptr->dequetail; idx++) {
+	    if (acquire_device_slot(workerptr->dirdeque[idx].device)) {
+		*diritemptr = workerptr->dirdeque[idx];
+		memmove(workerptr->dirdeque+workerptr->dequehead+1, workerptr->dirdeque+workerptr->dequehead,
+						(idx-workerptr->dequehead)*sizeof(Diritem));
+		workerptr->dequehead++;
+		foundflag = 1;
+		break;
+	    }
+	}
+    } else {
+	for (idx=workerptr->dequetail-1; idx>=workerptr->dequehead; idx--) {
+	    if (acquire_device_slot(workerptr->dirdeque[idx].device)) {
+		*diritemptr = workerptr->dirdeque[idx];
+		memmove(workerptr->dirdeque+idx, workerptr->dirdeque+idx+1, (workerptr->dequetail-idx-1)*sizeof(Diritem));
+		workerptr->dequetail--;
+		foundflag = 1;
+		break;
+	    }
+	}
+    }
+    pthread_mutex_unlock(&pendingdirslock);
+    if (workerptr->dequehead == workerptr->dequetail) {
+	workerptr->dequehead = workerptr->dequetail = 0;
+    }
+    return foundflag;
+}
+
+
+/*******************************************************************************
+Take a directory from a deque: the owner takes the most recently queued one
+(from the tail), other threads steal the oldest one (from the head) - which is
+usually nearer the top of the tree, so it is likely to have more work below it.
+Return 0 if the deque is empty. With -J, take the first of them (in that order)
+on a device that isn't already being read by the maximum number of threads.
+*******************************************************************************/
+int pop_directory(Workerinfo *workerptr, Diritem *diritemptr, int stealflag) {
+    int		foundflag = 0;
+
+    pthread_mutex_lock(&workerptr->dequelock);
+    if (maxdevicethreads > 0) {
+	foundflag = pop_directory_on_free_device(workerptr, diritemptr, stealflag);
+    } else if (workerptr->dequehead < workerptr->dequetail) {
+	if (stealflag) {
+	    *diritemptr = workerptr->dirdeque[workerptr->dequehead++];
+	} else {
+	    *diritemptr = workerptr->dirdeque[--workerptr->dequetail];
+	}
+	if (workerptr->dequehead == workerptr->dequetail) {
+	    workerptr->dequehead = workerptr->dequetail = 0;
+	}
+	foundflag = 1;
+    }
+    pthread_mutex_unlock(&workerptr->dequelock);
+    return foundflag;
+}
+
+
+/*******************************************************************************
+The body of each tree traversal thread. Read directories from this thread's own
+deque, or steal them from other threads' deques, until no directories are queued
+or being read by any thread.
+*******************************************************************************/
+void *traverse_tree_thread(void *argptr) {
+    Workerinfo	*workerptr = argptr;
+    Diritem	diritem;
+    long	lastnumdirspushed, lastnumdeviceslotsfreed;
+    int		idx, foundflag;
+
+    while (1) {
+	pthread_mutex_lock(&pendingdirslock);
+	lastnumdirspushed = numdirspushed;
+	lastnumdeviceslotsfreed = numdeviceslotsfreed;
+	pthread_mutex_unlock(&pendingdirslock);
+
+	foundflag = pop_directory(workerptr, &diritem, 0);
+	for (idx=1; !foundflag && idx<numthreads; idx++) {
+	    foundflag = pop_directory(&workertable[(workerptr->threadidx+idx)%numthreads], &diritem, 1);
+	}
+
+	if (foundflag) {
+	    workerptr->dirnodeptr = diritem.parentnodeptr;
+	    process_directory(AT_FDCWD, diritem.pathname, diritem.pathname, diritem.recursiondepth, workerptr);
+	    free(diritem.pathname);
+	    pthread_mutex_lock(&pendingdirslock);
+	    if (maxdevicethreads > 0) {
+		release_device_slot(diritem.device);
+		pthread_cond_broadcast(&pendingdirscond);	/* a queued directory on that device may be waiting */
+	    }
+	    if (--numpendingdirs == 0) {
+		pthread_cond_broadcast(&pendingdirscond);	/* the whole tree has been traversed */
+	    }
+	    pthread_mutex_unlock(&pendingdirslock);
+	} else {
+	    pthread_mutex_lock(&pendingdirslock);
+	    if (numpendingdirs == 0) {
+		pthread_mutex_unlock(&pendingdirslock);
+		break;
+	    }
+	    /* Nothing to steal yet: wait until another directory is queued or (-J) a device is freed
+	    (unless that already happened) */
+	    if (numdirspushed == lastnumdirspushed && numdeviceslotsfreed == lastnumdeviceslotsfreed) {
+		pthread_cond_wait(&pendingdirscond, &pendingdirslock);
+	    }
+	    pthread_mutex_unlock(&pendingdirslock);
+	}
+    }
+#if HAVEIOURING
+    close_uring(&workerptr->uring);
+#endif
+    return NULL;
+}
+
+
+/*******************************************************************************
+Traverse the tree below a command line target directory with numthreads threads.
+Each thread appends the objects it selects to its own object table. When all the
+threads have finished (and not before, as any thread may steal from any other's
+deque until then), their tables are appended to objecttable (the order
+does not matter because list_objects sorts objecttable).
+*******************************************************************************/
+void traverse_directory_in_parallel(char *pathname) {
+    Objectinfo	objectinfo;
+    Dirnode	*dirnodeptr;
+    int		threadidx, idx;
+
+    if (workertable == NULL && (workertable=calloc(MAXNUMTHREADS, sizeof(Workerinfo))) == NULL) {
+	perror("E: Could not calloc tree traversal thread table");
+	exit(1);
+    }
+
+    for (threadidx=0; threadidx<numthreads; threadidx++) {
+	workertable[threadidx].threadidx = threadidx;
+	pthread_mutex_init(&workertable[threadidx].dequelock, NULL);
+	workertable[threadidx].dequehead = workertable[threadidx].dequetail = 0;
+	workertable[threadidx].dequesize = INITDIRDEQUESIZE;
+	init_object_table(&workertable[threadidx].objecttable);
+	workertable[threadidx].namearena.nextnameptr = NULL;
+	workertable[threadidx].namearena.numbytesleft = 0;
+	workertable[threadidx].dirnodeptr = workertable[threadidx].allocateddirnodes = NULL;
+#if HAVEIOURING
+	workertable[threadidx].uring.ringfiledes = -1;
+#endif
+	if ((workertable[threadidx].dirdeque=malloc(INITDIRDEQUESIZE*sizeof(Diritem))) == NULL ||
+		(HAVEGETDENTS64 && (workertable[threadidx].dirbuffer=malloc(dirbuffersize)) == NULL)) {
+	    perror("E: insufficient memory - malloc failed");
+	    exit(1);
+	}
+    }
+
+    numpendingdirs = numdirspushed = numdeviceslotsfreed = 0;
+    push_directory(&workertable[0], pathname, 0, targetdevice);
+
+    for (threadidx=0; threadidx<numthreads; threadidx++) {
+	if (pthread_create(&workertable[threadidx].thread, NULL, traverse_tree_thread, &workertable[threadidx])) {
+	    perror("E: Could not create tree traversal thread");
+	    exit(1);
+	}
+    }
+
+    for (threadidx=0; threadidx<numthreads; threadidx++) {
+	pthread_join(workertable[threadidx].thread, NULL);
+    }
+    /* only now that every thread has finished stealing from the others' deques */
+    for (threadidx=0; threadidx<numthreads; threadidx++) {
+	for (idx=0; idx<workertable[threadidx].objecttable.numobjs; idx++) {
+	    get_stored_object(&workertable[threadidx].objecttable, idx, &objectinfo);
+	    if (limitheapflag) {
+		keep_limited_object(&objecttable, &objectinfo);
+	    } else {
+		store_object(&objecttable, &objectinfo, objectinfo.name);
+	    }
+	}
+	free_object_table(&workertable[threadidx].objecttable);
+	free(workertable[threadidx].dirdeque);
+	free(workertable[threadidx].dirbuffer);
+	while ((dirnodeptr=workertable[threadidx].allocateddirnodes) != NULL) {
+	    workertable[threadidx].allocateddirnodes = dirnodeptr->nextallocatedptr;
+	    free(dirnodeptr);
+	}
+	pthread_mutex_destroy(&workertable[threadidx].dequelock);
+    }
+}
+
+
+/*******************************************************************************
+Comparison function for sorting objects by time (as with qsort). The sort order
+is: seconds, then nanoseconds, then filename. It defines the order that
+get_sort_key packs (compare_object_function_ptr selects the order).
+*******************************************************************************/
+int compare_object_time_info(const void *firstptr, const void *secondptr) {
+    const Objectinfo	*firstobjinfoptr = firstptr;	/* to keep gcc happy */
+    const Objectinfo	*secondobjinfoptr = secondptr;
+
+    if (firstobjinfoptr->time_s != secondobjinfoptr->time_s) {
+	/* if the timestamp seconds value are different, sort by this */
+	return (secondobjinfoptr->time_s - firstobjinfoptr->time_s)*sortmultiplier;
+    } else {	/* if the timestamp seconds timestamp value are the same, check the ns */
+	if (firstobjinfoptr->time_ns != secondobjinfoptr->time_ns) {
+	    /* the timestamps ns values are different, sort by these */
+	    return (secondobjinfoptr->time_ns - firstobjinfoptr->time_ns)*sortmultiplier;
+	} else {
+	    /* the timestamps are the same (both s and ns), sort by name */
+	    return (strcoll(firstobjinfoptr->name, secondobjinfoptr->name))*sortmultiplier;
+	}
+    }
+}
+
+/*******************************************************************************
+Comparison function for sorting objects by size (as with qsort). The sort order
+is: size, then filename.
+*******************************************************************************/
+int compare_object_size_info(const void *firstptr, const void *secondptr) {
+    const Objectinfo	*firstobjinfoptr = firstptr;	/* to keep gcc happy */
+    const Objectinfo	*secondobjinfoptr = secondptr;
+
+    /* return (firstobjinfoptr->size-secondobjinfoptr->size)*sortmultiplier; cannot handle large object sizes! */
+    if (firstobjinfoptr->size > secondobjinfoptr->size) {
+	return sortmultiplier;
+    } else if (firstobjinfoptr->size < secondobjinfoptr->size) {
+	return -sortmultiplier;
+    } else {	/* If the sizes are the same size, sort by name */
+	return (strcoll(firstobjinfoptr->name, secondobjinfoptr->name))*sortmultiplier;
+    }
+}
+
+
+/*******************************************************************************
+Comparison function for sorting objects by object name (as with qsort).
+*******************************************************************************/
+int compare_object_name_info(const void *firstptr, const void *secondptr) {
+    const Objectinfo	*firstobjinfoptr = firstptr;	/* to keep gcc happy */
+    const Objectinfo	*secondobjinfoptr = secondptr;
+
+    return (strcoll(firstobjinfoptr->name, secondobjinfoptr->name))*sortmultiplier;
+}
+
+
+/*******************************************************************************
+Comparison function for sorting Namekeys (with qsort): compare the objects'
+collation keys (from strxfrm). strcmp on these gives the same result as strcoll
+on the names themselves - without transforming the names on every comparison.
+*******************************************************************************/
+int compare_name_keys(const void *firstptr, const void *secondptr) {
+    const Namekey	*firstnamekeyptr = firstptr;	/* to keep gcc happy */
+    const Namekey	*secondnamekeyptr = secondptr;
+
+    return strcmp(firstnamekeyptr->key, secondnamekeyptr->key);
+}
+
+
+/*******************************************************************************
+Sort the numobjs objecttable indexes in idxtable by the objects' names (in the
+locale's collation order). Each name is transformed (with strxfrm) just once,
+into the key buffer *keybufferptr (of *keybuffersizeptr bytes), which is
+enlarged if need be.
+*******************************************************************************/
+void sort_objects_by_name(int *idxtable, int numobjs, char **keybufferptr, size_t *keybuffersizeptr) {
+    Namekey	*namekeytable;
+    char	*oldkeybuffer;
+    size_t	offset = 0, keylength;
+    int		idx;
+
+    if ((namekeytable=malloc(numobjs*sizeof(Namekey))) == NULL) {
+	perror("E: insufficient memory - malloc failed");
+	exit(1);
+    }
+    for (idx=0; idx<numobjs; idx++) {
+	while ((keylength=strxfrm(*keybufferptr+offset, objecttable.names[idxtable[idx]], *keybuffersizeptr-offset)) >=
+										*keybuffersizeptr-offset) {
+	    *keybuffersizeptr = *keybuffersizeptr*2 > offset+keylength+1 ? *keybuffersizeptr*2 : offset+keylength+1;
+	    oldkeybuffer = *keybufferptr;
+	    if ((*keybufferptr=realloc(*keybufferptr, *keybuffersizeptr)) == NULL) {
+		perror("E: insufficient memory - realloc failed");
+		free(oldkeybuffer);		/* Only here to make Cppcheck happy */
+		exit(1);
+	    }
+	}
+	namekeytable[idx].offset = offset;
+	namekeytable[idx].idx = idxtable[idx];
+	offset += keylength+1;
+    }
+    for (idx=0; idx<numobjs; idx++) {
+	namekeytable[idx].key = *keybufferptr + namekeytable[idx].offset;
+    }
+
+    qsort((void*)namekeytable, (size_t)numobjs, sizeof(Namekey), compare_name_keys);
+    for (idx=0; idx<numobjs; idx++) {
+	idxtable[idx] = namekeytable[idx].idx;
+    }
+    free(namekeytable);
+}
+
+
+/*******************************************************************************
+Sort the numkeys Sortkeys in keytable by (hi, lo) with a (stable) least significant
+digit radix sort, one byte at a time. tmpkeytable must have room for numkeys
+Sortkeys too. The byte counts for all 16 bytes are gathered in one pass, and bytes
+that are the same in every key (eg, the high bytes of times) are skipped.
+*******************************************************************************/
+void radix_sort_keys(Sortkey *keytable, Sortkey *tmpkeytable, int numkeys) {
+    size_t		counttable[2*sizeof(uint64_t)][256];	/* 32kiB: (each sorting thread's) stack */
+    Sortkey		*fromkeytable = keytable, *tokeytable = tmpkeytable, *swapkeytable;
+    uint64_t		word;
+    size_t		total, count;
+    int			idx, byteidx, digit;
+
+    memset(counttable, 0, sizeof(counttable));
+    for (idx=0; idx<numkeys; idx++) {
+	for (byteidx=0; byteidx<(int)sizeof(uint64_t); byteidx++) {
+	    counttable[byteidx][(keytable[idx].lo >> (8*byteidx)) & 0xff]++;
+	    counttable[byteidx+sizeof(uint64_t)][(keytable[idx].hi >> (8*byteidx)) & 0xff]++;
+	}
+    }
+
+    for (byteidx=0; byteidx<2*(int)sizeof(uint64_t); byteidx++) {
+	word = byteidx < (int)sizeof(uint64_t) ? fromkeytable[0].lo : fromkeytable[0].hi;
+	if (counttable[byteidx][(word >> (8*(byteidx%sizeof(uint64_t)))) & 0xff] == (size_t)numkeys) {
+	    continue;		/* this byte is the same in every key */
+	}
+	for (total=0, digit=0; digit<256; digit++) {	/* counts to starting positions */
+	    count = counttable[byteidx][digit];
+	    counttable[byteidx][digit] = total;
+	    total += count;
+	}
+	for (idx=0; idx<numkeys; idx++) {
+	    word = byteidx < (int)sizeof(uint64_t) ? fromkeytable[idx].lo : fromkeytable[idx].hi;
+	    tokeytable[counttable[byteidx][(word >> (8*(byteidx%sizeof(uint64_t)))) & 0xff]++] = fromkeytable[idx];
+	}
+	swapkeytable = fromkeytable;
+	fromkeytable = tokeytable;
+	tokeytable = swapkeytable;
+    }
+
+    if (fromkeytable != keytable) {
+	memcpy(keytable, fromkeytable, numkeys*sizeof(Sortkey));
+    }
+}
+
+
+/*******************************************************************************
+Set *sortkeyptr to the packed sort key of an object with time time_s & time_ns
+and size size: its time, its size or (when sorting by name) nothing, such that
+sorting the keys (as 128-bit unsigned values) gives the order of
+compare_object_function_ptr (without -R).
+*******************************************************************************/
+void set_sort_key(time_t time_s, time_t time_ns, off_t size, Sortkey *sortkeyptr) {
+    if (compare_object_function_ptr == &compare_object_time_info) {	/* newest first */
+	sortkeyptr->hi = ~((uint64_t)time_s ^ SORTKEYSIGNBIT);
+	sortkeyptr->lo = (uint64_t)(NANOSECONDSPERSECOND-1 - time_ns);
+    } else if (compare_object_function_ptr == &compare_object_size_info) {	/* smallest first */
+	sortkeyptr->hi = (uint64_t)size ^ SORTKEYSIGNBIT;
+	sortkeyptr->lo = 0;
+    } else {	/* by name only */
+	sortkeyptr->hi = sortkeyptr->lo = 0;
+    }
+}
+
+
+/*******************************************************************************
+Set *sortkeyptr to the packed sort key of *objectinfoptr (see set_sort_key).
+*******************************************************************************/
+void get_sort_key(const Objectinfo *objectinfoptr, Sortkey *sortkeyptr) {
+    set_sort_key(objectinfoptr->time_s, objectinfoptr->time_ns, objectinfoptr->size, sortkeyptr);
+}
+
+
+/*******************************************************************************
+Set *sortkeyptr to the packed sort key of object idx in the object table
+*tableptr (see set_sort_key), reading only the column it's sorted by (if any).
+*******************************************************************************/
+void get_stored_sort_key(const Objecttable *tableptr, int idx, Sortkey *sortkeyptr) {
+    if (compare_object_function_ptr == &compare_object_time_info && (tableptr->fetchcodes[idx] & OBJTIMEFETCHED)) {
+	set_sort_key(tableptr->times_s[idx], tableptr->times_ns[idx], 0, sortkeyptr);
+    } else if (compare_object_function_ptr == &compare_object_size_info && (tableptr->fetchcodes[idx] & OBJSIZEFETCHED)) {
+	set_sort_key(DEFAULTAGE, DEFAULTAGE, tableptr->sizes[idx], sortkeyptr);
+    } else {
+	set_sort_key(DEFAULTAGE, DEFAULTAGE, 0, sortkeyptr);
+    }
+}
+
+
+/*******************************************************************************
+Sort the numobjs objecttable indexes in idxtable (without -R). The objects' sort
+keys are radix sorted. Then each run of objects with the same key (all of them,
+when sorting by name) is sorted by name, with the key buffer *keybufferptr (see
+sort_objects_by_name). Only the indexes move, not the objects.
+*******************************************************************************/
+void sort_object_range(int *idxtable, int numobjs, char **keybufferptr, size_t *keybuffersizeptr) {
+    Sortkey	*keytable, *tmpkeytable;
+    int		idx, runidx;
+
+    if (numobjs < 2) {
+	return;
+    }
+    if ((keytable=malloc(numobjs*sizeof(Sortkey))) == NULL ||
+		(tmpkeytable=malloc(numobjs*sizeof(Sortkey))) == NULL) {
+	perror("E: insufficient memory - malloc failed");
+	exit(1);
+    }
+
+    for (idx=0; idx<numobjs; idx++) {
+	get_stored_sort_key(&objecttable, idxtable[idx], &keytable[idx]);
+	keytable[idx].idx = idxtable[idx];
+    }
+    radix_sort_keys(keytable, tmpkeytable, numobjs);
+    for (idx=0; idx<numobjs; idx++) {
+	idxtable[idx] = keytable[idx].idx;
+    }
+
+    for (runidx=0; runidx<numobjs; runidx=idx) {
+	for (idx=runidx+1; idx<numobjs && keytable[idx].hi == keytable[runidx].hi &&
+						keytable[idx].lo == keytable[runidx].lo; idx++);
+	if (idx-runidx > 1) {
+	    sort_objects_by_name(&idxtable[runidx], idx-runidx, keybufferptr, keybuffersizeptr);
+	}
+    }
+    free(tmpkeytable);
+    free(keytable);
+}
+
+
+/*******************************************************************************
+Compare two objects in sort_object_range's order: by their sort keys, then names.
+*******************************************************************************/
+int compare_sort_keys(const Sortkey *firstkeyptr, const char *firstname, const Sortkey *secondkeyptr, const char *secondname) {
+    if (firstkeyptr->hi != secondkeyptr->hi) {
+	return firstkeyptr->hi < secondkeyptr->hi ? -1 : 1;
+    } else if (firstkeyptr->lo != secondkeyptr->lo) {
+	return firstkeyptr->lo < secondkeyptr->lo ? -1 : 1;
+    }
+    return strcoll(firstname, secondname);
+}
+
+
+/*******************************************************************************
+Return the bucket (0 to numsorters-1) of object idx (of objecttable): the number
+of splitters that sort before it. So objects that sort the same are always in
+the same bucket.
+*******************************************************************************/
+int get_object_bucket(int idx) {
+    Sortkey	sortkey;
+    int		lowidx = 0, highidx = numsorters-1, mididx;
+
+    get_stored_sort_key(&objecttable, idx, &sortkey);
+    while (lowidx < highidx) {
+	mididx = (lowidx+highidx)/2;
+	if (compare_sort_keys(&splittertable[mididx], splitternametable[mididx], &sortkey, objecttable.names[idx]) < 0) {
+	    lowidx = mididx+1;
+	} else {
+	    highidx = mididx;
+	}
+    }
+    return lowidx;
+}
+
+
+/*******************************************************************************
+Each sorting thread (a sample sort): 1. count how many of its share of the
+objects go in each bucket, 2. copy them to their buckets in bucketedtable and 3.
+sort its own bucket. The threads wait for each other between the steps.
+*******************************************************************************/
+void *sort_objects_thread(void *argptr) {
+    Sorterinfo	*sorterptr = argptr;
+    int		firstidx, lastidx, idx, *bucketpositionptr;
+
+    firstidx = (long)objecttable.numobjs*sorterptr->threadidx/numsorters;
+    lastidx = (long)objecttable.numobjs*(sorterptr->threadidx+1)/numsorters;
+    bucketpositionptr = &bucketcounttable[sorterptr->threadidx*numsorters];
+
+    for (idx=firstidx; idx<lastidx; idx++) {
+	objectbuckettable[idx] = get_object_bucket(idx);
+	bucketpositionptr[objectbuckettable[idx]]++;
+    }
+    pthread_barrier_wait(&sorterbarrier);	/* the main thread converts the counts to positions */
+    pthread_barrier_wait(&sorterbarrier);
+
+    for (idx=firstidx; idx<lastidx; idx++) {
+	bucketedtable[bucketpositionptr[objectbuckettable[idx]]++] = idx;
+    }
+    pthread_barrier_wait(&sorterbarrier);
+
+    /* bucket threadidx starts where the last thread's bucket threadidx-1 ended */
+    firstidx = sorterptr->threadidx == 0 ? 0 : bucketcounttable[(numsorters-1)*numsorters + sorterptr->threadidx-1];
+    lastidx = bucketcounttable[(numsorters-1)*numsorters + sorterptr->threadidx];
+    sort_object_range(&bucketedtable[firstidx], lastidx-firstidx, &sorterptr->namekeybuffer, &sorterptr->namekeybuffersize);
+    free(sorterptr->namekeybuffer);
+    return NULL;
+}
+
+
+/*******************************************************************************
+Sort the objecttable indexes (into sortedidxtable) with numsorters threads (a
+sample sort): a sample of the objects is sorted, and numsorters-1 evenly spaced
+ones are chosen as splitters. These divide the objects into numsorters buckets
+(each object is in the bucket between the two splitters it sorts between), and
+each thread sorts one bucket. The buckets, in order, are the sorted indexes.
+*******************************************************************************/
+void sort_objects_in_parallel() {
+    int		*sampletable;
+    int		numsamples = numsorters*SORTSAMPLESPERTHREAD, sorteridx, bucketidx, idx, position = 0;
+
+    if ((sortertable=calloc(numsorters, sizeof(Sorterinfo))) == NULL ||
+		(splittertable=malloc(numsorters*sizeof(Sortkey))) == NULL ||
+		(splitternametable=malloc(numsorters*sizeof(char *))) == NULL ||
+		(objectbuckettable=malloc(objecttable.numobjs)) == NULL ||
+		(sampletable=malloc(numsamples*sizeof(int))) == NULL ||
+		(bucketedtable=malloc(objecttable.numobjs*sizeof(int))) == NULL ||
+		(bucketcounttable=calloc(numsorters*numsorters, sizeof(int))) == NULL) {
+	perror("E: insufficient memory - malloc failed");
+	exit(1);
+    }
+
+    for (idx=0; idx<numsamples; idx++) {
+	sampletable[idx] = (long)objecttable.numobjs*idx/numsamples;
+    }
+    sort_object_range(sampletable, numsamples, &namekeybuffer, &namekeybuffersize);
+    for (idx=0; idx<numsorters-1; idx++) {
+	get_stored_sort_key(&objecttable, sampletable[numsamples*(idx+1)/numsorters], &splittertable[idx]);
+	splitternametable[idx] = objecttable.names[sampletable[numsamples*(idx+1)/numsorters]];
+    }
+    free(sampletable);
+
+    pthread_barrier_init(&sorterbarrier, NULL, numsorters+1);
+    for (sorteridx=0; sorteridx<numsorters; sorteridx++) {
+	sortertable[sorteridx].threadidx = sorteridx;
+	if (pthread_create(&sortertable[sorteridx].thread, NULL, sort_objects_thread, &sortertable[sorteridx])) {
+	    perror("E: Could not create sorting thread");
+	    exit(1);
+	}
+    }
+
+    pthread_barrier_wait(&sorterbarrier);	/* all the objects have been counted */
+    for (bucketidx=0; bucketidx<numsorters; bucketidx++) {
+	for (sorteridx=0; sorteridx<numsorters; sorteridx++) {
+	    idx = bucketcounttable[sorteridx*numsorters+bucketidx];
+	    bucketcounttable[sorteridx*numsorters+bucketidx] = position;
+	    position += idx;
+	}
+    }
+    pthread_barrier_wait(&sorterbarrier);	/* now the threads can copy their objects */
+    pthread_barrier_wait(&sorterbarrier);	/* ... which they have */
+
+    for (sorteridx=0; sorteridx<numsorters; sorteridx++) {
+	pthread_join(sortertable[sorteridx].thread, NULL);
+    }
+    pthread_barrier_destroy(&sorterbarrier);
+
+    sortedidxtable = bucketedtable;
+    free(bucketcounttable);
+    free(objectbuckettable);
+    free(splitternametable);
+    free(splittertable);
+    free(sortertable);
+}
+
+
+/*******************************************************************************
+Sort objecttable in the same order as qsort with compare_object_function_ptr
+would (see sort_object_range): set sortedidxtable to its indexes in that order.
+When there are at least FF_PARALLELSORT objects, they are sorted by several
+threads (one per CPU). -R simply reverses the result.
+*******************************************************************************/
+void sort_objects() {
+    long	numcpus;
+    int		idx, swapidx;
+
+    numcpus = sysconf(_SC_NPROCESSORS_ONLN);
+    numsorters = numcpus < 1 ? 1 : numcpus > MAXNUMTHREADS ? MAXNUMTHREADS : numcpus;
+    if (numsorters > 1 && objecttable.numobjs >= parallelsortminimum && objecttable.numobjs >= numsorters*SORTSAMPLESPERTHREAD) {
+	sort_objects_in_parallel();
+    } else {
+	if ((sortedidxtable=malloc((objecttable.numobjs+1)*sizeof(int))) == NULL) {
+	    perror("E: insufficient memory - malloc failed");
+	    exit(1);
+	}
+	for (idx=0; idx<objecttable.numobjs; idx++) {
+	    sortedidxtable[idx] = idx;
+	}
+	sort_object_range(sortedidxtable, objecttable.numobjs, &namekeybuffer, &namekeybuffersize);
+    }
+
+    if (sortmultiplier == -1) {
+	for (idx=0; idx<objecttable.numobjs/2; idx++) {
+	    swapidx = sortedidxtable[idx];
+	    sortedidxtable[idx] = sortedidxtable[objecttable.numobjs-1-idx];
+	    sortedidxtable[objecttable.numobjs-1-idx] = swapidx;
+	}
+    }
+}
+
+
+/*******************************************************************************
+Display an object's information - optionally, the timestamp and age, and (always)
+the name. The line is formatted into outputbuffer (with format_integer rather than
+printf, unless FF_DATETIMEFORMAT or FF_AGEFORMAT have been customized). Due to
+storing times in two variables (*_s and *_ns), it is necessary to add 1s to the
+objectage_ns value and subtract 1s from the objectage_s value whenever
+starttime_ns < the_object's_age_in_ns.
+*******************************************************************************/
+void list_object(const Objectinfo *objectinfoptr) {
+    struct tm	*localtimeinfoptr, localtimeinfo;
+    char	objectagestr[MAXOBJAGESTRLEN], *chptr;
+    int		negativeageflag, length;
+    time_t	objectage_s, objectage_ns, absobjectage_s, days, hrs, mins, secs;
+
+    if (verbosity > 0) {
+	if (verbosity > 2) {		/* Test/debug: object time in s and ns */
+	    append_formatted_output("%10ld.%09ld = ", objectinfoptr->time_s,
+		objectinfoptr->time_ns);
+	}
+
+	/* year, month day, hour, minute, second */
+	localtimeinfoptr = get_local_time(&objectinfoptr->time_s, &localtimeinfo, &outputtimecache);
+	if (defaultdatetimeformatflag && localtimeinfoptr->tm_year+TMBASEYEAR >= 0 &&
+						localtimeinfoptr->tm_year+TMBASEYEAR <= 9999) {
+	    chptr = get_output_space(MAXDATESTRLENGTH);
+	    chptr += format_integer(chptr, localtimeinfoptr->tm_year+TMBASEYEAR, 4, '0');
+	    chptr += format_integer(chptr, localtimeinfoptr->tm_mon+TMBASEMONTH, 2, '0');
+	    chptr += format_integer(chptr, localtimeinfoptr->tm_mday, 2, '0');
+	    *chptr++ = '_';
+	    chptr += format_integer(chptr, localtimeinfoptr->tm_hour, 2, '0');
+	    chptr += format_integer(chptr, localtimeinfoptr->tm_min, 2, '0');
+	    chptr += format_integer(chptr, localtimeinfoptr->tm_sec, 2, '0');
+	    outputlength = chptr - outputbuffer;
+	} else {
+	    append_formatted_output(datetimeformatstr, localtimeinfoptr->tm_year+TMBASEYEAR,
+		localtimeinfoptr->tm_mon+TMBASEMONTH, localtimeinfoptr->tm_mday,
+		localtimeinfoptr->tm_hour, localtimeinfoptr->tm_min, localtimeinfoptr->tm_sec);
+	}
+	if (displaynsecflag) {		/* ns */
+	    append_output(".", 1);
+	    append_integer(objectinfoptr->time_ns, 9, '0');
+	}
+
+	if (starttime_s > objectinfoptr->time_s || /* starttime >= object's time */
+				    (starttime_s == objectinfoptr->time_s &&
+				    starttime_ns >= objectinfoptr->time_ns)) {
+	    objectage_s = starttime_s - objectinfoptr->time_s;
+	    if (starttime_ns >= objectinfoptr->time_ns) {
+		objectage_ns = starttime_ns - objectinfoptr->time_ns;
+	    } else {
+		objectage_ns = starttime_ns - objectinfoptr->time_ns + NANOSECONDSPERSECOND;
+		objectage_s--;
+	    }
+	    negativeageflag = 0;
+	} else {					/* object's time is after starttime - future! */
+	    objectage_s = starttime_s - objectinfoptr->time_s;
+	    if (starttime_ns <= objectinfoptr->time_ns) {
+		objectage_ns = objectinfoptr->time_ns - starttime_ns;
+	    } else {
+		objectage_ns = objectinfoptr->time_ns - starttime_ns + NANOSECONDSPERSECOND;
+		objectage_s++;
+	    }
+	    negativeageflag = 1;
+	}
+
+	if (verbosity > 2) {		/* Test/debug: object age in s and ns */
+	    append_formatted_output(" %10ld.%09ld = ", objectage_s, objectage_ns);
+	}
+
+	if (displaysecondsflag) {	/* object age in seconds */
+	    append_integer(objectage_s, 16, ' ');
+	    if (displaynsecflag) {
+		append_output(".", 1);
+		append_integer(objectage_ns, 9, '0');
+	    }
+	    chptr = get_output_space(2);
+	    *chptr++ = secondsunitchar;
+	    *chptr = ' ';
+	    outputlength += 2;
+	} else {				/* object age in days, hours, minutes and seconds */
+	    absobjectage_s = objectage_s >= 0 ? objectage_s : -objectage_s;	/* absolute value */
+	    days = absobjectage_s/SECONDSPERDAY;
+	    hrs = absobjectage_s/SECONDSPERHOUR - days*HOURSPERDAY;
+	    mins = absobjectage_s/SECONDSPERMINUTE - days*MINUTESPERDAY - hrs*MINUTESPERHOUR;
+	    secs = absobjectage_s % SECONDSPERMINUTE;
+	    if (defaultageformatflag && days < 10000000) {
+		length = format_integer(objectagestr, days, 7, ' ');
+		objectagestr[length++] = 'D';
+		objectagestr[length++] = '_';
+		length += format_integer(objectagestr+length, hrs, 2, '0');
+		objectagestr[length++] = ':';
+		length += format_integer(objectagestr+length, mins, 2, '0');
+		objectagestr[length++] = ':';
+		length += format_integer(objectagestr+length, secs, 2, '0');
+		objectagestr[length] = '\0';
+	    } else {
+		sprintf(objectagestr, ageformatstr, days, hrs, mins, secs);
+	    }
+	    /* if objectage_s is negative (future timestamp), display a - sign */
+	    if (negativeageflag) {
+		if ((chptr=strrchr(objectagestr, ' ')) != NULL) {
+		    *chptr = NEGATIVESIGNCHAR; /* %07ld : OK for 999999 days - until the year 4707 */
+		} else {
+		    flush_output_buffer();
+		    fprintf(stderr, "E: Insufficient 'days' field width in '%s'\n", ageformatstr);
+		    exit(1);
+		}
+	    }
+	    append_output(objectagestr, strlen(objectagestr));
+
+	    if (displaynsecflag) {
+		append_output(".", 1);
+		append_integer(objectage_ns, 9, '0');
+	    }
+	    append_output(" ", 1);
+	}
+
+	if (humanunittable == NULL) {
+	    append_output(" ", 1);
+	    append_integer(objectinfoptr->size, 14, ' ');
+	    chptr = get_output_space(3);
+	    *chptr++ = bytesunitchar;
+	    *chptr++ = ' ';
+	    *chptr = ' ';
+	    outputlength += 3;
+	} else {
+	    display_human_readable_size(objectinfoptr->size);
+	}
+    }
+
+    if (displaytypesflag) {
+	append_output(typecodenametable[get_type_code(objectinfoptr->type)], 4);
+    }
+    length = strlen(objectinfoptr->name);
+    chptr = get_output_space(length+1);
+    if (length+1 > OUTPUTBUFSIZE) {	/* can't happen in practice */
+	append_output(objectinfoptr->name, length);
+	append_output("\n", 1);
+    } else {
+	memcpy(chptr, objectinfoptr->name, length);
+	chptr[length] = '\n';
+	outputlength += length+1;
+    }
+}
+
+
+/*******************************************************************************
+Can the dates and ages be formatted without printf (are FF_DATETIMEFORMAT and
+FF_AGEFORMAT the defaults)? Set whenever either of them is set, not per object.
+*******************************************************************************/
+void set_output_format_flags() {
+    defaultdatetimeformatflag = !strcmp(datetimeformatstr, DEFAULTDATETIMEFORMAT);
+    defaultageformatflag = !strcmp(ageformatstr, DEFAULTAGEFORMAT);
+}
+
+
+/*******************************************************************************
+Sort objecttable by time (or name or size), and display the objects. Only the
+columns that are displayed are read.
+*******************************************************************************/
+void list_objects() {
+    Objectinfo	objectinfo;
+    int		foundidx;
+
+    stat_pending_objects();
+    sort_objects();
+    for (foundidx=0; foundidx<objecttable.numobjs && (objectlimit == 0 || foundidx < objectlimit); foundidx++) {
+	get_stored_object(&objecttable, sortedidxtable[foundidx], &objectinfo);
+	list_object(&objectinfo);
+    }
+    flush_output_buffer();
+}
+
+
+/*******************************************************************************
+With -O/--no-sort, each selected object is listed as soon as it is found instead
+of being stored in an object table. Tree traversal threads (-j) take turns.
+*******************************************************************************/
+void list_object_unsorted(const Objectinfo *objectinfoptr) {
+    pthread_mutex_lock(&outputlock);
+    if (objectlimit == 0 || numobjslisted < objectlimit) {
+	list_object(objectinfoptr);
+	flush_output_buffer();	/* so stdout's buffering applies - line by line to a terminal */
+	numobjslisted++;
+    }
+    pthread_mutex_unlock(&outputlock);
+}
+
+
+/*******************************************************************************
+Integer values must be used with units 'M' (months) and 'Y' (years) because
+months and years vary in size. E.g., '0.5M' does NOT always equate to the same
+amount of time, but 1.33s, 0.25h, 0.5m, 0.1W, etc., all do.
+*******************************************************************************/
+void check_integer(char *relativeagestr) {
+    char	*chptr;
+
+    for (chptr=relativeagestr; chptr<relativeagestr+strlen(relativeagestr)-1; chptr++) {
+	if (!isdigit(*chptr) && *chptr != NEGATIVESIGNCHAR && *chptr != POSITIVESIGNCHAR) {
+	    fprintf(stderr, "E: non-integer character '%c' in '%s'!\n", *chptr, relativeagestr);
+	    exit(-1);
+	}
+    }
+}
+
+
+/*******************************************************************************
+Convert a (hopefully numeric) string to the equivalent number of nanoseconds (ns).
+Eg "123" to 123000000, "000123" to 123000 and "000000123" to 123.
 *******************************************************************************/
 int convert_string_to_ns(char *fractionstr) {
     char	nanosecondsstr[] = NANOSECONDSSTR;
     const char	*fromchptr = fractionstr;
     char	*tochptr = nanosecondsstr+1;
 
-    while (*fromchptr && *tochptr) {
-	if (isdigit(*fromchptr)) {
-	    *tochptr++ = *fromchptr++;
+    while (*fromchptr && *tochptr) {
+	if (isdigit(*fromchptr)) {
+	    *tochptr++ = *fromchptr++;
+	} else {
+	    fprintf(stderr, "E: Illegal character ('%c') in time fraction string '%s'\n", *fromchptr, fractionstr);
+	    exit(1);
+	}
+    }
+    return atoi(nanosecondsstr) - NANOSECONDSPERSECOND;
+}
+
+
+/*******************************************************************************
+Adjust the relative age of targettime when called with units of seconds. The
+reason for not using adjust_relative_age (below) is because when that function
+is called with a large integer (s), the fraction (ns) is sometimes rounded.
+See below. This function returns the correct number of nanoseconds.
+*******************************************************************************/
+time_t adjust_relative_age_seconds(const char *relativeagestr, int *timeunitptr) {
+    char	*decimalseparatorcharptr, trimmedrelativeagestr[sizeof(NANOSECONDSSTR)-1] = { '\0' };
+    int		trimmedrelativeagestrlen, relativeage_ns = 0;
+
+    *timeunitptr -= atoi(relativeagestr);	/* relativeage_s: integer */
+    if ((decimalseparatorcharptr=strchr(relativeagestr, decimalseparatorchar)) != NULL) { /* fraction */
+	/* copy only up to 9 chars. (trimmedrelativeagestr is initialized to all '\0' chars) */
+	strncpy(trimmedrelativeagestr, decimalseparatorcharptr+1, sizeof(NANOSECONDSSTR)-2);
+	/* if the last character is 's' (seconds), remove it from trimmedrelativeagestr */
+	trimmedrelativeagestrlen = strlen(trimmedrelativeagestr);
+	if (trimmedrelativeagestr[trimmedrelativeagestrlen-1] == 's') {
+	    trimmedrelativeagestr[trimmedrelativeagestrlen-1] = '\0';
+	}
+    }
+    relativeage_ns = convert_string_to_ns(trimmedrelativeagestr);
+    return relativeage_ns;
+}
+
+
+/*******************************************************************************
+Adjust the relative age of targettime. Parse the relativeagestr argument (a
+string representing floating point number) into integer and (optional) fraction
+parts. Update the breakdown time structure (timeinfoptr, see below) by the
+calculated integer number of seconds, and return the calculated number of ns.
+*******************************************************************************/
+time_t adjust_relative_age(const char *relativeagestr, int *timeunitptr, long secsperunit) {
+    double	relativeage_s, relativeage_ns;
+
+    relativeage_s = atof(relativeagestr) * secsperunit;
+    relativeage_ns = relativeage_s - (long)relativeage_s;
+    *timeunitptr -= (int)relativeage_s;
+    return (time_t)(relativeage_ns * NANOSECONDSPERSECOND);
+}
+
+
+/*******************************************************************************
+Set the targettime (_s and _ns) relative to the start time. For example, -m 2D
+for 2 days ago or -a -10m for 10 minutes ago.
+*******************************************************************************/
+void set_relative_targettime(char *timeinfostr, struct tm *timeinfoptr, char timeunitchar) {
+    time_t	relativeage_ns = DEFAULTAGE;
+    char	*charptr;
+    int		foundillegalcharflag = 0;
+    int		decimalseparatorcount = 0;
+
+    switch (timeunitchar) {		/* set targettime relative to now */
+	case 's': relativeage_ns = adjust_relative_age_seconds(timeinfostr, &(timeinfoptr->tm_sec));
+	    break;
+	case 'm': relativeage_ns = adjust_relative_age(timeinfostr, &(timeinfoptr->tm_sec), SECONDSPERMINUTE);
+	    break;
+	case 'h': relativeage_ns = adjust_relative_age(timeinfostr, &(timeinfoptr->tm_sec), SECONDSPERHOUR);
+	    break;
+	case 'D': relativeage_ns = adjust_relative_age(timeinfostr, &(timeinfoptr->tm_sec), SECONDSPERDAY);
+	    break;
+	case 'W': relativeage_ns = adjust_relative_age(timeinfostr, &(timeinfoptr->tm_sec), SECONDSPERWEEK);
+	    break;
+	case 'M': check_integer(timeinfostr);
+	    timeinfoptr->tm_mon -= atoi(timeinfostr);
+	    break;
+	case 'Y': check_integer(timeinfostr);
+	    timeinfoptr->tm_year -= atoi(timeinfostr);
+	    break;
+	default: fprintf(stderr, "E: Illegal time unit '%c'\n", timeunitchar);
+	    exit(1);
+    }
+    targettime_s = mktime(timeinfoptr);
+
+    /* Check for illegal timeinfostr format. Loop though all but the last char of timeinfostr */
+    charptr=timeinfostr;
+    if (*charptr == NEGATIVESIGNCHAR || *charptr == POSITIVESIGNCHAR) {
+	charptr++;	/* If the first character is a +/- sign, skip it */
+    }
+    while (charptr < timeinfostr+strlen(timeinfostr)-1) {
+	if (*charptr == decimalseparatorchar) {
+	    decimalseparatorcount++;		/* count the decimal separator char(s) */
+	}
+	/* If this is an illegal character (non-digit or a decimal separator char) */
+	if (!isdigit(*charptr) && *charptr != decimalseparatorchar) {
+	    foundillegalcharflag = 1;
+	    break;
+	}
+	charptr++;
+    }
+
+    if (foundillegalcharflag || decimalseparatorcount > 1) {
+	fprintf(stderr, "E: Illegal character ('%c'): in relative age '%s'\n", *charptr, timeinfostr);
+	exit(1);
+    }
+
+    /* Due to storing times in two variables (_s and _ns), it is necessary to add 1s to
+	the targettime_ns value and subtract 1s from the targettime_s value whenever
+	starttime_ns < relativeage_ns. */
+    if (starttime_ns >= relativeage_ns) {
+	targettime_ns = starttime_ns - relativeage_ns;
+    } else {
+	targettime_ns = starttime_ns - relativeage_ns + NANOSECONDSPERSECOND;
+	targettime_s--;
+    }
+}
+
+
+/*******************************************************************************
+Return the word used in information messages for a MODTIMEINFOCHAR,
+ACCTIMEINFOCHAR, CHGTIMEINFOCHAR or BIRTHTIMEINFOCHAR time.
+*******************************************************************************/
+const char *get_time_info_name(char objecttimeinfochar) {
+    if (objecttimeinfochar == ACCTIMEINFOCHAR) {
+	return "accessed";
+    } else if (objecttimeinfochar == CHGTIMEINFOCHAR) {
+	return "changed";
+    } else if (objecttimeinfochar == BIRTHTIMEINFOCHAR) {
+	return "created";
+    } else {
+	return "modified";
+    }
+}
+
+
+/*******************************************************************************
+Convert a time in seconds to a locale-specific (language, TZ) date string.
+*******************************************************************************/
+void convert_time_s_to_date_string(time_t time_s, char *datestr) {
+    struct tm	timeinfo;
+
+    get_local_time(&time_s, &timeinfo, &infotimecache);
+    strftime(datestr, MAXDATESTRLENGTH, infodatetimeformatstr, &timeinfo);
+}
+
+
+/*******************************************************************************
+Display the starttime in s.ns in a more easily readable format.
+*******************************************************************************/
+void list_starttime() {
+    char	datestr[MAXDATESTRLENGTH];
+
+    convert_time_s_to_date_string(starttime_s, datestr);
+    fprintf(stderr, "i: start time:  %15ld.%09lds ~= %s\n", starttime_s, starttime_ns, datestr);
+    fflush(stderr);
+}
+
+
+/*******************************************************************************
+Convert a text input string (representing a timestamp) into a time since the
+Epoch (s in *time_s_ptr and ns in *time_ns_ptr).
+*******************************************************************************/
+void convert_text_time_to_s_and_ns(char *timeinfostr, char *formatstr, struct tm *timeinfoptr, time_t *time_s_ptr, time_t *time_ns_ptr) {
+    size_t	timestampformatstrlen;
+    char	*decimalseparatorcharptr;
+
+    *time_ns_ptr = DEFAULTAGE;		/* set to zero unless a fraction of a second is specified */
+    /* convert the command line timeinfostr (eg, YYYYMMDD_HHMMSS) to a breakdown time structure (struct tm)
+    and return a pointer to anything after the allowed format (formatstr), if any (which should be a decimal
+    fraction of a second - eg, ".25" */
+    decimalseparatorcharptr = strptime(timeinfostr, formatstr, timeinfoptr);
+
+    timeinfoptr->tm_isdst = -1; /* set is_dst to -1 so mktime will try to determine whether DST is in effect */
+    *time_s_ptr = mktime(timeinfoptr);	/* convert the breakdowns time structure to the number of seconds */
+
+    if (decimalseparatorcharptr == NULL) {
+	fprintf(stderr, "E: bad timestamp: '%s' must be in format '%s[.ns]'\n", timeinfostr, formatstr);
+	exit(1);
+    } else if (*decimalseparatorcharptr == decimalseparatorchar) {	/* if a decimalseparatorchar follows a valid timestamp */
+	/* Ensure that the last characters of formatstr (eg, %Y%m%d_%H%M%S) are SECONDSFORMATSTR ("%S") */
+	timestampformatstrlen = strlen(formatstr);
+	if (timestampformatstrlen < sizeof(SECONDSFORMATSTR)-1 ||
+		strcmp(formatstr+timestampformatstrlen-(sizeof(SECONDSFORMATSTR)-1), SECONDSFORMATSTR)) {
+	    fprintf(stderr, "E: last two characters of '%s' must be '%s' when using fractions of seconds\n",
+		formatstr, SECONDSFORMATSTR);
+	    exit(1);
+	}
+	*time_ns_ptr = convert_string_to_ns(decimalseparatorcharptr+1);
+    } else if (*decimalseparatorcharptr != '\0') {
+	fprintf(stderr, "E: Illegal timestamp character(s) starting at '%c' in timestamp '%s'\n",
+	    *decimalseparatorcharptr, timeinfostr);
+	exit(1);
+    }
+}
+
+
+/*******************************************************************************
+Set targettime from a command line argumet in one of two formats:
+1. When the last character of timeinfostr is one of Y, M, D, h, m or s: by
+   subtracting the relative) "age" command line argument, e.g., "15D" from
+   starttime. Note: targettime will always be less than starttime. I.e., "-30s"
+   and "[+]30s" both result in targettime = starttime-30s.
+2. When the last character of timeinfostr is a digit: by using timeinfostr
+   as a timestamp. timestampformatstr (default "%Y%m%d_%H%M%S", and configurable
+   with FF_TIMESTAMPFORMAT) is used to parse the value. So timestamps must be
+   entered in the format YYYYMMDD_HHMMSS[.secondfraction] unless the environment
+   variable FF_TIMESTAMPFORMAT is changed.
+In either case, a first character of '-' is used to set the newerthantargetflag.
+This function is called for last access, last modification, status change and
+birth times.
+*******************************************************************************/
+void set_target_time_by_cmd_line_arg(char *timeinfostr, char cmdlineoptchar) {
+    char	timeunitchar;
+    struct tm	timeinfo;
+    char	datestr[MAXDATESTRLENGTH];
+    time_t	relativeage_s, relativeage_ns;
+
+    if (cmdlineoptchar == BIRTHTIMEINFOCHAR && !HAVESTATX) {
+	fprintf(stderr, "E: Birth times (-b) are not supported on this system\n");
+	exit(1);
+    }
+    if (!timekeyflag) {
+	timeinfochar = cmdlineoptchar;	/* MODTIMEINFOCHAR, ACCTIMEINFOCHAR, CHGTIMEINFOCHAR or BIRTHTIMEINFOCHAR */
+    }
+
+    timeunitchar = *(timeinfostr+strlen(timeinfostr+1));
+    localtime_r(&starttime_s, &timeinfo);
+
+    /* is the last character of timeinfostr is a digit or a decimalseparatorchar? */
+    if (isdigit(timeunitchar) || timeunitchar == decimalseparatorchar) {
+	/* Set the absolute time - for both (-m) modification and (-a) access - based on the
+	required format. The default is '%Y%m%d_%H%M%S', but this can be changed by by setting
+	FF_TIMESTAMPFORMAT. It is possible to specify a subset of these. If not all of year to
+	second are specified, the values of the start time are used to fill the missing values.
+	For example, one could set FF_TIMESTAMPFORMAT to 'date:%m%d, hour:%H' and specify only
+	'date:', month, day, ', hour:', and hour, e.g., 'date:1231, hour:23' - or '%d%m%H' and
+	'311223'). See strptime for details. */
+	if (*timeinfostr == NEGATIVESIGNCHAR) {
+	    newerthantargetflag = 0;
+	    timeinfostr++;
+	} else {
+	    newerthantargetflag = 1;
+	    if (*timeinfostr == POSITIVESIGNCHAR) {
+		timeinfostr++;
+	    }
+	}
+	convert_text_time_to_s_and_ns(timeinfostr, timestampformatstr, &timeinfo, &targettime_s, &targettime_ns);
+    } else {	/* relative age */
+	if (*timeinfostr == NEGATIVESIGNCHAR) {
+	    /* eg, (-m) '-15D' find objects modified <= 15 days ago (newer than) */
+	    newerthantargetflag = 1;
+	    timeinfostr++;
+	} else {
+	    /* eg, (-a) '[+]15D' find objects accessed >= 15 days ago (older than) */
+	    newerthantargetflag = 0;
+	}
+	set_relative_targettime(timeinfostr, &timeinfo, timeunitchar);
+    }
+
+    if (verbosity > 1) {
+	if (targettime_s <= starttime_s) {	/* ('normal') targettime is before startttime */
+	    if (targettime_ns <= starttime_ns) {
+		relativeage_s = starttime_s - targettime_s;
+		relativeage_ns = starttime_ns - targettime_ns;
+	    } else {
+		relativeage_s = starttime_s - targettime_s - 1;
+		relativeage_ns = starttime_ns - targettime_ns + NANOSECONDSPERSECOND;
+	    }
+	} else {				/* (future) targettime is after starttime */
+	    if (targettime_ns <= starttime_ns) {
+		relativeage_s = starttime_s - targettime_s + 1;
+		relativeage_ns = NANOSECONDSPERSECOND - (starttime_ns - targettime_ns);
+	    } else {
+		relativeage_s = starttime_s - targettime_s;
+		relativeage_ns = targettime_ns - starttime_ns;
+	    }
+	}
+
+	convert_time_s_to_date_string(targettime_s, datestr);
+	fprintf(stderr, "i: target time: %15ld.%09lds ~= %s\n", targettime_s, targettime_ns, datestr);
+	fprintf(stderr, "i: %13.5fD ~= %10ld.%09lds last %s %s target time ('%s')\n",
+	    (float)(starttime_s-targettime_s)/SECONDSPERDAY, relativeage_s,
+	    relativeage_ns, get_time_info_name(cmdlineoptchar),
+	    newerthantargetflag ? "after (newer than)" : "before (older than)", timeinfostr);
+	list_starttime();
+	fflush(stderr);
+    }
+}
+
+
+/*******************************************************************************
+Set targettime to be the same as that of the reference object's last modification
+or last access time, as required.
+*******************************************************************************/
+void set_target_time_by_object_time(char *targetobjectstr, char cmdlineoptchar) {
+    struct stat	statinfo;
+    char	datestr[MAXDATESTRLENGTH];
+    char	objecttimeinfochar = cmdlineoptchar == REFMODTIMECHAR ? MODTIMEINFOCHAR : ACCTIMEINFOCHAR;
+
+    if (*targetobjectstr == NEGATIVESIGNCHAR) {
+	/* eg, "-M -foo" find objects last modified BEFORE foo was (OLDER than) */
+	newerthantargetflag = 0;
+	targetobjectstr++;
+    } else {
+	/* eg, "-M [+]foo" find objects last modified AFTER foo was (OLDER than) */
+	newerthantargetflag = 1;
+	if (*targetobjectstr == POSITIVESIGNCHAR) {
+	    targetobjectstr++;
+	}
+    }
+
+    if (*targetobjectstr && (lstat(targetobjectstr, &statinfo) != -1)) {
+	if (!timekeyflag) {
+	    timeinfochar = objecttimeinfochar;
+	}
+	if (cmdlineoptchar == REFMODTIMECHAR) {
+	    targettime_s = statinfo.st_mtime;
+	    targettime_ns = statinfo.st_mtim.tv_nsec;
 	} else {
-	    fprintf(stderr, "E: Illegal character ('%c') in time fraction string '%s'\n", *fromchptr, fractionstr);
-	    exit(1);
+	    targettime_s = statinfo.st_atime;
+	    targettime_ns = statinfo.st_atim.tv_nsec;
 	}
+    } else {
+	fprintf(stderr, "E: Cannot access '%s'\n", targetobjectstr);
+	exit(1);
     }
-    return atoi(nanosecondsstr) - NANOSECONDSPERSECOND;
+
+    if (verbosity > 1) {
+	fprintf(stderr, "i: last %s %s than '%s'\n", get_time_info_name(objecttimeinfochar),
+	    newerthantargetflag ? "after (newer than)" : "before (older than)", targetobjectstr);
+	convert_time_s_to_date_string(targettime_s, datestr);
+	fprintf(stderr, "i: target time: %15ld.%09lds ~= %s\n", targettime_s, targettime_ns, datestr);
+	list_starttime();
+	fflush(stderr);
+    }
+
+    if (newerthantargetflag) {
+        if (targettime_ns < NANOSECONDSPERSECOND-1) {	/* +1ns for NEWER than (NOT the same age!) */
+	    targettime_ns += 1;
+	} else {			/* eg, 340.999999999 -> 341.000000000 */
+	    targettime_s += 1;
+	    targettime_ns = 0;
+	}
+    } else {						/* -1ns for OLDER than (NOT the same age!) */
+        if (targettime_ns != 0) {
+	    targettime_ns -= 1;
+	} else {			/* eg, 341.000000000 -> 340.999999999 */
+	    targettime_s -= 1;
+	    targettime_ns = NANOSECONDSPERSECOND-1;
+	}
+    }
+    set_time_predicate(objecttimeinfochar);
 }
 
 
 /*******************************************************************************
-Adjust the relative age of targettime when called with units of seconds. The
-reason for not using adjust_relative_age (below) is because when that function
-is called with a large integer (s), the fraction (ns) is sometimes rounded.
-See below. This function returns the correct number of nanoseconds.
+Remove the selection predicates of kind (and timeidx, for PREDTIME, unless it's
+-1). A predicate that was OR'ed with a removed one that started a group starts
+it instead.
 *******************************************************************************/
-time_t adjust_relative_age_seconds(const char *relativeagestr, int *timeunitptr) {
-    char	*decimalseparatorcharptr, trimmedrelativeagestr[sizeof(NANOSECONDSSTR)-1] = { '\0' };
-    int		trimmedrelativeagestrlen, relativeage_ns = 0;
+void remove_select_predicates(int kind, int timeidx) {
+    int		idx, keptidx = 0, groupstartflag = 0;
 
-    *timeunitptr -= atoi(relativeagestr);	/* relativeage_s: integer */
-    if ((decimalseparatorcharptr=strchr(relativeagestr, decimalseparatorchar)) != NULL) { /* fraction */
-	/* copy only up to 9 chars. (trimmedrelativeagestr is initialized to all '\0' chars) */
-	strncpy(trimmedrelativeagestr, decimalseparatorcharptr+1, sizeof(NANOSECONDSSTR)-2);
-	/* if the last character is 's' (seconds), remove it from trimmedrelativeagestr */
-	trimmedrelativeagestrlen = strlen(trimmedrelativeagestr);
-	if (trimmedrelativeagestr[trimmedrelativeagestrlen-1] == 's') {
-	    trimmedrelativeagestr[trimmedrelativeagestrlen-1] = '\0';
+    for (idx=0; idx<numselectpredicates; idx++) {
+	if (selectpredicatetable[idx].kind == kind && (timeidx == -1 || selectpredicatetable[idx].timeidx == timeidx)) {
+	    groupstartflag |= !selectpredicatetable[idx].orflag;
+	    continue;
+	}
+	selectpredicatetable[keptidx] = selectpredicatetable[idx];
+	if (groupstartflag || keptidx == 0) {
+	    selectpredicatetable[keptidx].orflag = 0;
 	}
+	groupstartflag = 0;
+	keptidx++;
     }
-    relativeage_ns = convert_string_to_ns(trimmedrelativeagestr);
-    return relativeage_ns;
+    numselectpredicates = keptidx;
 }
 
 
 /*******************************************************************************
-Adjust the relative age of targettime. Parse the relativeagestr argument (a
-string representing floating point number) into integer and (optional) fraction
-parts. Update the breakdown time structure (timeinfoptr, see below) by the
-calculated integer number of seconds, and return the calculated number of ns.
+Return a new selection predicate of kind (and timeidx, for PREDTIME), with the
+pending -e|--not & -G|--or flags. Unless it's OR'ed with the previous one, it
+replaces the previous ones of that kind (all of them, once a target has been
+processed since the last one was set, see resetpredicatekinds).
 *******************************************************************************/
-time_t adjust_relative_age(const char *relativeagestr, int *timeunitptr, long secsperunit) {
-    double	relativeage_s, relativeage_ns;
-
-    relativeage_s = atof(relativeagestr) * secsperunit;
-    relativeage_ns = relativeage_s - (long)relativeage_s;
-    *timeunitptr -= (int)relativeage_s;
-    return (time_t)(relativeage_ns * NANOSECONDSPERSECOND);
+Selectpredicate *add_select_predicate(int kind, int timeidx) {
+    Selectpredicate	*predicateptr;
+
+    if (resetpredicatekinds & (1 << kind)) {
+	remove_select_predicates(kind, -1);
+	resetpredicatekinds &= ~(1 << kind);
+    } else if (!ornextflag) {
+	remove_select_predicates(kind, timeidx);
+    }
+    if (numselectpredicates == MAXNUMPREDICATES) {
+	fprintf(stderr, "E: Too many selection predicates (at most %d), aborting\n", MAXNUMPREDICATES);
+	exit(1);
+    }
+    predicateptr = &selectpredicatetable[numselectpredicates++];
+    predicateptr->kind = kind;
+    predicateptr->timeidx = timeidx;
+    predicateptr->negateflag = negatenextflag;
+    predicateptr->orflag = ornextflag && predicateptr > selectpredicatetable;
+    negatenextflag = ornextflag = 0;
+    return predicateptr;
 }
 
 
 /*******************************************************************************
-Set the targettime (_s and _ns) relative to the start time. For example, -m 2D
-for 2 days ago or -a -10m for 10 minutes ago.
+Set the time predicate for the objecttimeinfochar time to the (just set) target
+time and newerthantargetflag: the range from the target time on, or up to it.
 *******************************************************************************/
-void set_relative_targettime(char *timeinfostr, struct tm *timeinfoptr, char timeunitchar) {
-    time_t	relativeage_ns = DEFAULTAGE;
-    char	*charptr;
-    int		foundillegalcharflag = 0;
-    int		decimalseparatorcount = 0;
+void set_time_predicate(char objecttimeinfochar) {
+    Selectpredicate	*predicateptr = add_select_predicate(PREDTIME, get_time_index(objecttimeinfochar));
 
-    switch (timeunitchar) {		/* set targettime relative to now */
-	case 's': relativeage_ns = adjust_relative_age_seconds(timeinfostr, &(timeinfoptr->tm_sec));
-	    break;
-	case 'm': relativeage_ns = adjust_relative_age(timeinfostr, &(timeinfoptr->tm_sec), SECONDSPERMINUTE);
-	    break;
-	case 'h': relativeage_ns = adjust_relative_age(timeinfostr, &(timeinfoptr->tm_sec), SECONDSPERHOUR);
-	    break;
-	case 'D': relativeage_ns = adjust_relative_age(timeinfostr, &(timeinfoptr->tm_sec), SECONDSPERDAY);
-	    break;
-	case 'W': relativeage_ns = adjust_relative_age(timeinfostr, &(timeinfoptr->tm_sec), SECONDSPERWEEK);
-	    break;
-	case 'M': check_integer(timeinfostr);
-	    timeinfoptr->tm_mon -= atoi(timeinfostr);
-	    break;
-	case 'Y': check_integer(timeinfostr);
-	    timeinfoptr->tm_year -= atoi(timeinfostr);
-	    break;
-	default: fprintf(stderr, "E: Illegal time unit '%c'\n", timeunitchar);
-	    exit(1);
+    if (newerthantargetflag) {
+	predicateptr->lowtime_s = targettime_s;
+	predicateptr->lowtime_ns = targettime_ns;
+	predicateptr->hightime_s = MAXTIME_S;
+	predicateptr->hightime_ns = NANOSECONDSPERSECOND-1;
+    } else {
+	predicateptr->lowtime_s = MINTIME_S;
+	predicateptr->lowtime_ns = 0;
+	predicateptr->hightime_s = targettime_s;
+	predicateptr->hightime_ns = targettime_ns;
     }
-    targettime_s = mktime(timeinfoptr);
+}
 
-    /* Check for illegal timeinfostr format. Loop though all but the last char of timeinfostr */
-    charptr=timeinfostr;
-    if (*charptr == NEGATIVESIGNCHAR || *charptr == POSITIVESIGNCHAR) {
-	charptr++;	/* If the first character is a +/- sign, skip it */
+
+/*******************************************************************************
+-a, -b, -C & -m: set the time predicate for cmdlineoptchar's time. The time can
+be a range of ages and/or times: eg, '30D..7D' (between 30 and 7 days ago) or
+'20250101_000000..20250201_000000' - whichever is the earlier.
+*******************************************************************************/
+void set_select_time(char *optarg, char cmdlineoptchar) {
+    Selectpredicate	*predicateptr;
+    char		*separatorptr;
+    time_t		firsttime_s, firsttime_ns;
+
+    if ((separatorptr=strstr(optarg, RANGESEPARATORSTR)) == NULL) {
+	set_target_time_by_cmd_line_arg(optarg, cmdlineoptchar);
+	set_time_predicate(cmdlineoptchar);
+	return;
     }
-    while (charptr < timeinfostr+strlen(timeinfostr)-1) {
-	if (*charptr == decimalseparatorchar) {
-	    decimalseparatorcount++;		/* count the decimal separator char(s) */
+    *separatorptr = '\0';
+    set_target_time_by_cmd_line_arg(optarg, cmdlineoptchar);
+    firsttime_s = targettime_s;
+    firsttime_ns = targettime_ns;
+    set_target_time_by_cmd_line_arg(separatorptr+sizeof(RANGESEPARATORSTR)-1, cmdlineoptchar);
+    *separatorptr = RANGESEPARATORSTR[0];
+
+    predicateptr = add_select_predicate(PREDTIME, get_time_index(cmdlineoptchar));
+    if (firsttime_s < targettime_s || (firsttime_s == targettime_s && firsttime_ns <= targettime_ns)) {
+	predicateptr->lowtime_s = firsttime_s;
+	predicateptr->lowtime_ns = firsttime_ns;
+	predicateptr->hightime_s = targettime_s;
+	predicateptr->hightime_ns = targettime_ns;
+    } else {
+	predicateptr->lowtime_s = targettime_s;
+	predicateptr->lowtime_ns = targettime_ns;
+	predicateptr->hightime_s = firsttime_s;
+	predicateptr->hightime_ns = firsttime_ns;
+    }
+}
+
+
+/*******************************************************************************
+Compile the selection predicates into the predicate program (see
+run_predicate_program). Each predicate becomes an operation, and each predicate
+that isn't OR'ed with the next one ends a group. The groups are then (stably)
+sorted by cost: uid equality first, then size ranges, then time ranges - and
+within those, ranges bounded on both sides (which are usually more selective)
+before one-sided ones.
+*******************************************************************************/
+void compile_predicate_program() {
+    Predicateop		optable[MAXNUMPREDICATES], *opptr;
+    const Selectpredicate *predicateptr;
+    int			groupcosttable[MAXNUMPREDICATES], groupstarttable[MAXNUMPREDICATES+1];
+    int			ordertable[MAXNUMPREDICATES], numgroups = 0, idx, groupidx, sortidx, cost;
+
+    for (idx=0; idx<numselectpredicates; idx++) {
+	predicateptr = &selectpredicatetable[idx];
+	opptr = &optable[idx];
+	memset(opptr, 0, sizeof(Predicateop));
+	opptr->negateflag = predicateptr->negateflag;
+	if (predicateptr->kind == PREDUID) {
+	    opptr->opcode = OPUIDEQUAL;
+	    opptr->uid = predicateptr->uid;
+	    cost = 0;
+	} else if (predicateptr->kind == PREDSIZE) {
+	    opptr->opcode = OPSIZERANGE;
+	    opptr->lowsize = predicateptr->lowsize;
+	    opptr->highsize = predicateptr->highsize;
+	    cost = predicateptr->lowsize > 0 && predicateptr->highsize < MAXOBJECTSIZE ? 1 : 2;
+	} else {
+	    opptr->opcode = OPTIMERANGE;
+	    opptr->timeidx = predicateptr->timeidx;
+	    opptr->lowtime_s = predicateptr->lowtime_s;
+	    opptr->lowtime_ns = predicateptr->lowtime_ns;
+	    opptr->hightime_s = predicateptr->hightime_s;
+	    opptr->hightime_ns = predicateptr->hightime_ns;
+	    cost = predicateptr->lowtime_s > MINTIME_S && predicateptr->hightime_s < MAXTIME_S ? 3 : 4;
 	}
-	/* If this is an illegal character (non-digit or a decimal separator char) */
-	if (!isdigit(*charptr) && *charptr != decimalseparatorchar) {
-	    foundillegalcharflag = 1;
-	    break;
+	if (!predicateptr->orflag) {
+	    groupstarttable[numgroups] = idx;
+	    groupcosttable[numgroups++] = cost;
+	} else if (cost > groupcosttable[numgroups-1]) {	/* a group costs as much as its dearest operation */
+	    groupcosttable[numgroups-1] = cost;
 	}
-	charptr++;
     }
+    groupstarttable[numgroups] = numselectpredicates;
 
-    if (foundillegalcharflag || decimalseparatorcount > 1) {
-	fprintf(stderr, "E: Illegal character ('%c'): in relative age '%s'\n", *charptr, timeinfostr);
+    for (groupidx=0; groupidx<numgroups; groupidx++) {	/* insertion sort: there are few of them */
+	for (sortidx=groupidx; sortidx>0 && groupcosttable[ordertable[sortidx-1]] > groupcosttable[groupidx]; sortidx--) {
+	    ordertable[sortidx] = ordertable[sortidx-1];
+	}
+	ordertable[sortidx] = groupidx;
+    }
+    numpredicateops = 0;
+    for (sortidx=0; sortidx<numgroups; sortidx++) {
+	groupidx = ordertable[sortidx];
+	for (idx=groupstarttable[groupidx]; idx<groupstarttable[groupidx+1]; idx++) {
+	    predicateprogram[numpredicateops] = optable[idx];
+	    predicateprogram[numpredicateops].nextgroupidx = numpredicateops - idx + groupstarttable[groupidx+1];
+	    predicateprogram[numpredicateops++].lastingroupflag = idx == groupstarttable[groupidx+1]-1;
+	}
+    }
+}
+
+
+/*******************************************************************************
+-k/--time-key: list (& sort by) the objecttimeinfochar time of the objects, whatever
+time predicates are set.
+*******************************************************************************/
+void set_time_key(const char *timekeystr) {
+    if (strlen(timekeystr) != 1 || strchr(TIMEINFOCHARS, *timekeystr) == NULL) {
+	fprintf(stderr, "E: Time key '%s' must be one of m, a, C or b, aborting\n", timekeystr);
+	exit(1);
+    }
+    if (*timekeystr == BIRTHTIMEINFOCHAR && !HAVESTATX) {
+	fprintf(stderr, "E: Birth times (-b) are not supported on this system\n");
 	exit(1);
     }
+    timeinfochar = *timekeystr;
+    timekeyflag = 1;
+}
 
-    /* Due to storing times in two variables (_s and _ns), it is necessary to add 1s to
-	the targettime_ns value and subtract 1s from the targettime_s value whenever
-	starttime_ns < relativeage_ns. */
-    if (starttime_ns >= relativeage_ns) {
-	targettime_ns = starttime_ns - relativeage_ns;
-    } else {
-	targettime_ns = starttime_ns - relativeage_ns + NANOSECONDSPERSECOND;
-	targettime_s--;
+
+/*******************************************************************************
+Return a pointer to the character after the bracket expression that starts at
+cptr (which points to the '['), or NULL if the bracket expression isn't closed.
+*******************************************************************************/
+const char *skip_bracket_expression(const char *cptr) {
+    char	delimiterchar;
+
+    cptr++;
+    if (*cptr == '^') {
+	cptr++;
+    }
+    if (*cptr == ']') {				/* a leading ']' is part of the list */
+	cptr++;
+    }
+    while (*cptr != '\0' && *cptr != ']') {
+	if (*cptr == '[' && (cptr[1] == ':' || cptr[1] == '.' || cptr[1] == '=')) {
+	    delimiterchar = cptr[1];		/* eg, [:alpha:], [.-.] or [=e=] */
+	    for (cptr+=2; *cptr!='\0' && !(*cptr == delimiterchar && cptr[1] == ']'); cptr++) {
+		;
+	    }
+	    if (*cptr == '\0') {
+		return NULL;
+	    }
+	    cptr += 2;
+	} else {
+	    cptr++;
+	}
     }
+    return *cptr == ']' ? cptr+1 : NULL;
 }
 
 
 /*******************************************************************************
-Convert a time in seconds to a locale-specific (language, TZ) date string.
+Return a pointer to the character after the group that starts at cptr (which
+points to the '('), or NULL if the group isn't closed.
 *******************************************************************************/
-void convert_time_s_to_date_string(time_t time_s, char *datestr) {
-    struct tm	timeinfo;
+const char *skip_group(const char *cptr) {
+    int		depth;
+
+    for (depth=1, cptr++; *cptr!='\0' && depth>0; ) {
+	switch (*cptr) {
+	    case '\\':
+		if (cptr[1] == '\0') {
+		    return NULL;
+		}
+		cptr += 2;
+		break;
+	    case '[':
+		if ((cptr=skip_bracket_expression(cptr)) == NULL) {
+		    return NULL;
+		}
+		break;
+	    case '(': depth++; cptr++; break;
+	    case ')': depth--; cptr++; break;
+	    default: cptr++; break;
+	}
+    }
+    return depth == 0 ? cptr : NULL;
+}
 
-    localtime_r(&time_s, &timeinfo);
-    strftime(datestr, MAXDATESTRLENGTH, infodatetimeformatstr, &timeinfo);
+
+/*******************************************************************************
+Return 1 if the locale maps the case of ASCII characters the usual way (eg, not
+Turkish dotted/dotless i), 0 otherwise.
+*******************************************************************************/
+int ascii_case_mapping_is_standard() {
+    int		c;
+
+    for (c=0; c<128; c++) {
+	if (tolower(c) != ASCIITOLOWER(c) || toupper(c) != (c >= 'a' && c <= 'z' ? c-'a'+'A' : c)) {
+	    return 0;
+	}
+    }
+    return 1;
 }
 
 
 /*******************************************************************************
-Display the starttime in s.ns in a more easily readable format.
+Scan the ERE erestr for the longest run of literal characters that every matching
+name must contain. If the ERE is nothing but that literal (optionally anchored with
+'^' and/or '$'), match_object_name can decide the match without calling regexec.
+Otherwise the literal is a prefilter: names that don't contain it are rejected
+without calling regexec. Alternation, back-references, GNU escapes (eg, '\w') and
+non-ASCII characters are left entirely to regexec. A literal followed by '*', '?'
+or '{' is optional, so it is dropped from the run.
 *******************************************************************************/
-void list_starttime() {
-    char	datestr[MAXDATESTRLENGTH];
+void set_ere_literal(const char *erestr, Ereinfo *ereptr) {
+    const char	*cptr;
+    char	*runstr;
+    size_t	runlength, erelength;
+    int		pureflag, startflag, endflag, atomflag, literalflag;
+
+    ereptr->literalkind = ERELITERALNONE;
+    ereptr->multibyteflag = MB_CUR_MAX > 1;
+    if (ereptr->icaseflag && !ascii_case_mapping_is_standard()) {
+	return;
+    }
 
-    convert_time_s_to_date_string(starttime_s, datestr);
-    fprintf(stderr, "i: start time:  %15ld.%09lds ~= %s\n", starttime_s, starttime_ns, datestr);
-    fflush(stderr);
+    erelength = strlen(erestr);
+    if ((runstr=(char*)malloc(erelength+1)) == NULL || (ereptr->literal=(char*)malloc(erelength+1)) == NULL) {
+	perror("E: Could not malloc ERE literal");
+	exit(1);
+    }
+    ereptr->literallength = runlength = 0;
+    pureflag = 1;
+    endflag = atomflag = literalflag = 0;
+
+#define END_LITERAL_RUN	\
+    if (runlength > ereptr->literallength) {			\
+	memcpy(ereptr->literal, runstr, runlength);		\
+	ereptr->literallength = runlength;			\
+    }								\
+    runlength = 0;
+
+    cptr = erestr;
+    if ((startflag = *cptr == '^')) {
+	cptr++;
+    }
+    while (*cptr != '\0') {
+	if (*cptr & 0x80) {
+	    goto noliteral;				/* non-ASCII: leave it all to regexec */
+	}
+	switch (*cptr) {
+	    case '\\':
+		if (cptr[1] == '\0' || strchr(".[]()*+?{}|^$\\", cptr[1]) == NULL) {
+		    goto noliteral;			/* eg, back-reference or GNU '\w', '\b', etc. */
+		}
+		cptr++;
+		runstr[runlength++] = ereptr->icaseflag ? ASCIITOLOWER(*cptr) : *cptr;
+		cptr++;
+		atomflag = literalflag = 1;
+		break;
+	    case '$':
+		if (cptr[1] != '\0') {
+		    goto noliteral;
+		}
+		endflag = 1;
+		cptr++;
+		break;
+	    case '^':					/* '^' not at the start */
+	    case '|':					/* alternation */
+	    case ')':					/* unmatched ')' */
+		goto noliteral;
+	    case '.':
+	    case '[':
+	    case '(':
+		END_LITERAL_RUN
+		if (*cptr == '.') {
+		    cptr++;
+		} else if ((cptr = *cptr == '[' ? skip_bracket_expression(cptr) : skip_group(cptr)) == NULL) {
+		    goto noliteral;
+		}
+		pureflag = literalflag = 0;
+		atomflag = 1;
+		break;
+	    case '*':
+	    case '?':
+	    case '{':
+	    case '+':
+		if (!atomflag) {
+		    goto noliteral;			/* quantifier with nothing to quantify */
+		}
+		if (literalflag && *cptr != '+') {
+		    runlength--;			/* the last literal is optional */
+		}
+		END_LITERAL_RUN
+		if (*cptr == '{' && (cptr=strchr(cptr, '}')) == NULL) {
+		    goto noliteral;
+		}
+		cptr++;
+		pureflag = literalflag = 0;
+		break;
+	    default:
+		runstr[runlength++] = ereptr->icaseflag ? ASCIITOLOWER(*cptr) : *cptr;
+		cptr++;
+		atomflag = literalflag = 1;
+		break;
+	}
+    }
+    END_LITERAL_RUN
+#undef END_LITERAL_RUN
+    free(runstr);
+
+    if (ereptr->literallength == 0) {
+	return;
+    } else if (!pureflag) {
+	ereptr->literalkind = ERELITERALFILTER;
+    } else if (startflag) {
+	ereptr->literalkind = endflag ? ERELITERALEXACT : ERELITERALPREFIX;
+    } else {
+	ereptr->literalkind = endflag ? ERELITERALSUFFIX : ERELITERALCONTAINS;
+    }
+    return;
+
+noliteral:
+    free(runstr);
+    free(ereptr->literal);
+    ereptr->literal = NULL;
+    ereptr->literallength = 0;
 }
 
 
 /*******************************************************************************
-Convert a text input string (representing a timestamp) into a time since the
-Epoch (s in *time_s_ptr and ns in *time_ns_ptr).
+Make sure eretable has room for (at least) one more ERE.
 *******************************************************************************/
-void convert_text_time_to_s_and_ns(char *timeinfostr, char *formatstr, struct tm *timeinfoptr, time_t *time_s_ptr, time_t *time_ns_ptr) {
-    size_t	timestampformatstrlen;
-    char	*decimalseparatorcharptr;
+void grow_ere_table() {
+    if (numeres >= maxnumeres) {	/* number of EREs */
+	maxnumeres = maxnumeres > 0 ? maxnumeres * 2 : INITMAXNUMERES;
+	if ((eretable=(Ereinfo*)realloc(eretable, maxnumeres*sizeof(Ereinfo))) == NULL) {
+	    perror("E: Could not realloc ERE table");
+	    exit(1);
+	}
+    }
+}
 
-    *time_ns_ptr = DEFAULTAGE;		/* set to zero unless a fraction of a second is specified */
-    /* convert the command line timeinfostr (eg, YYYYMMDD_HHMMSS) to a breakdown time structure (struct tm)
-    and return a pointer to anything after the allowed format (formatstr), if any (which should be a decimal
-    fraction of a second - eg, ".25" */
-    decimalseparatorcharptr = strptime(timeinfostr, formatstr, timeinfoptr);
 
-    timeinfoptr->tm_isdst = -1; /* set is_dst to -1 so mktime will try to determine whether DST is in effect */
-    *time_s_ptr = mktime(timeinfoptr);	/* convert the breakdowns time structure to the number of seconds */
+/*******************************************************************************
+Compile the extended regular expression erestr into *ereptr.
+*******************************************************************************/
+#define MAXREGCOMPERRMSGLEN	64
+void compile_extended_regular_expression(const char *erestr, int matchcode, Ereinfo *ereptr) {
+    char	regcomperrmsg[MAXREGCOMPERRMSGLEN];
+    int		cflags;
+    int		regcompretval;
 
-    if (decimalseparatorcharptr == NULL) {
-	fprintf(stderr, "E: bad timestamp: '%s' must be in format '%s[.ns]'\n", timeinfostr, formatstr);
+    if (ignorecaseflag) {
+	cflags = REG_EXTENDED|REG_ICASE;
+    } else {
+	cflags = REG_EXTENDED;
+    }
+
+    if ((regcompretval=regcomp(&ereptr->compiledere, erestr, cflags)) != 0) {
+	regerror(regcompretval, &ereptr->compiledere, regcomperrmsg, MAXREGCOMPERRMSGLEN);
+	printf("E: Regular expression error for '%s': %s\n", erestr, regcomperrmsg);
 	exit(1);
-    } else if (*decimalseparatorcharptr == decimalseparatorchar) {	/* if a decimalseparatorchar follows a valid timestamp */
-	/* Ensure that the last characters of formatstr (eg, %Y%m%d_%H%M%S) are SECONDSFORMATSTR ("%S") */
-	timestampformatstrlen = strlen(formatstr);
-	if (timestampformatstrlen < sizeof(SECONDSFORMATSTR)-1 ||
-		strcmp(formatstr+timestampformatstrlen-(sizeof(SECONDSFORMATSTR)-1), SECONDSFORMATSTR)) {
-	    fprintf(stderr, "E: last two characters of '%s' must be '%s' when using fractions of seconds\n",
-		formatstr, SECONDSFORMATSTR);
+    }
+    ereptr->matchcode = matchcode;
+    ereptr->icaseflag = ignorecaseflag;
+    ereptr->ereset = NULL;
+    set_ere_literal(erestr, ereptr);
+}
+
+
+/*******************************************************************************
+Set the extended regular expression (pattern) to be used to match the object names.
+*******************************************************************************/
+void set_extended_regular_expression(char *erestr, int matchcode) {
+    grow_ere_table();
+    compile_extended_regular_expression(erestr, matchcode, &eretable[numeres++]);
+}
+
+
+/*******************************************************************************
+-K/--prune: add an extended regular expression matching the names of directories
+that are not to be traversed (they can still be selected themselves).
+*******************************************************************************/
+void set_prune_expression(const char *erestr) {
+    if (numprunes >= maxnumprunes) {
+	maxnumprunes = maxnumprunes > 0 ? maxnumprunes * 2 : INITMAXNUMERES;
+	if ((prunetable=(Ereinfo*)realloc(prunetable, maxnumprunes*sizeof(Ereinfo))) == NULL) {
+	    perror("E: Could not realloc prune ERE table");
 	    exit(1);
 	}
-	*time_ns_ptr = convert_string_to_ns(decimalseparatorcharptr+1);
-    } else if (*decimalseparatorcharptr != '\0') {
-	fprintf(stderr, "E: Illegal timestamp character(s) starting at '%c' in timestamp '%s'\n",
-	    *decimalseparatorcharptr, timeinfostr);
-	exit(1);
     }
+    compile_extended_regular_expression(erestr, REG_MATCH, &prunetable[numprunes++]);
 }
 
 
 /*******************************************************************************
-Set targettime from a command line argumet in one of two formats:
-1. When the last character of timeinfostr is one of Y, M, D, h, m or s: by
-   subtracting the relative) "age" command line argument, e.g., "15D" from
-   starttime. Note: targettime will always be less than starttime. I.e., "-30s"
-   and "[+]30s" both result in targettime = starttime-30s.
-2. When the last character of timeinfostr is a digit: by using timeinfostr
-   as a timestamp. timestampformatstr (default "%Y%m%d_%H%M%S", and configurable
-   with FF_TIMESTAMPFORMAT) is used to parse the value. So timestamps must be
-   entered in the format YYYYMMDD_HHMMSS[.secondfraction] unless the environment
-   variable FF_TIMESTAMPFORMAT is changed.
-In either case, a first character of '-' is used to set the newerthantargetflag.
-This function is called for both last access time and last modification time.
+Return 1 if the ERE erestr contains a back-reference (eg, '\1'), 0 otherwise.
 *******************************************************************************/
-void set_target_time_by_cmd_line_arg(char *timeinfostr, char cmdlineoptchar) {
-    char	timeunitchar;
-    struct tm	timeinfo;
-    char	datestr[MAXDATESTRLENGTH];
-    time_t	relativeage_s, relativeage_ns;
-
-    if (cmdlineoptchar == MODTIMEINFOCHAR) {
-	accesstimeflag = 0;
-    } else {
-	accesstimeflag = 1;
+int ere_has_back_reference(const char *erestr) {
+    for ( ; *erestr!='\0'; erestr++) {
+	if (*erestr == '\\') {
+	    if (*++erestr >= '1' && *erestr <= '9') {
+		return 1;
+	    } else if (*erestr == '\0') {
+		break;
+	    }
+	}
     }
+    return 0;
+}
 
-    timeunitchar = *(timeinfostr+strlen(timeinfostr+1));
-    localtime_r(&starttime_s, &timeinfo);
 
-    /* is the last character of timeinfostr is a digit or a decimalseparatorchar? */
-    if (isdigit(timeunitchar) || timeunitchar == decimalseparatorchar) {
-	/* Set the absolute time - for both (-m) modification and (-a) access - based on the
-	required format. The default is '%Y%m%d_%H%M%S', but this can be changed by by setting
-	FF_TIMESTAMPFORMAT. It is possible to specify a subset of these. If not all of year to
-	second are specified, the values of the start time are used to fill the missing values.
-	For example, one could set FF_TIMESTAMPFORMAT to 'date:%m%d, hour:%H' and specify only
-	'date:', month, day, ', hour:', and hour, e.g., 'date:1231, hour:23' - or '%d%m%H' and
-	'311223'). See strptime for details. */
-	if (*timeinfostr == NEGATIVESIGNCHAR) {
-	    newerthantargetflag = 0;
-	    timeinfostr++;
-	} else {
-	    newerthantargetflag = 1;
-	    if (*timeinfostr == POSITIVESIGNCHAR) {
-		timeinfostr++;
-	    }
-	}
-	convert_text_time_to_s_and_ns(timeinfostr, timestampformatstr, &timeinfo, &targettime_s, &targettime_ns);
-    } else {	/* relative age */
-	if (*timeinfostr == NEGATIVESIGNCHAR) {
-	    /* eg, (-m) '-15D' find objects modified <= 15 days ago (newer than) */
-	    newerthantargetflag = 1;
-	    timeinfostr++;
-	} else {
-	    /* eg, (-a) '[+]15D' find objects accessed >= 15 days ago (older than) */
-	    newerthantargetflag = 0;
+/*******************************************************************************
+Compile the numstrs EREs in erestrtable into as few regexes as possible: all those
+without back-references are merged into one, '(ERE1)|(ERE2)|...', which regexec
+matches in a single pass. EREs with back-references (whose group numbers would
+change) and, if the merged ERE won't compile, all the others are compiled on their
+own. Return the table of regexes and set *numregexesptr.
+*******************************************************************************/
+regex_t *compile_merged_eres(char **erestrtable, int numstrs, int cflags, int *numregexesptr) {
+    regex_t	*regextable;
+    char	*mergedstr, *cptr;
+    size_t	mergedlength;
+    int		idx, nummerged, numregexes, mergedflag;
+    int		*backrefflagtable;
+
+    if ((regextable=(regex_t*)malloc((numstrs+1)*sizeof(regex_t))) == NULL ||
+	(backrefflagtable=(int*)malloc((numstrs+1)*sizeof(int))) == NULL) {
+	perror("E: Could not malloc regex table");
+	exit(1);
+    }
+    mergedlength = 1;
+    nummerged = 0;
+    for (idx=0; idx<numstrs; idx++) {
+	if (!(backrefflagtable[idx]=ere_has_back_reference(erestrtable[idx]))) {
+	    mergedlength += strlen(erestrtable[idx]) + 3;	/* '(', ')' & '|' */
+	    nummerged++;
 	}
-	set_relative_targettime(timeinfostr, &timeinfo, timeunitchar);
     }
 
-    if (verbosity > 1) {
-	if (targettime_s <= starttime_s) {	/* ('normal') targettime is before startttime */
-	    if (targettime_ns <= starttime_ns) {
-		relativeage_s = starttime_s - targettime_s;
-		relativeage_ns = starttime_ns - targettime_ns;
-	    } else {
-		relativeage_s = starttime_s - targettime_s - 1;
-		relativeage_ns = starttime_ns - targettime_ns + NANOSECONDSPERSECOND;
-	    }
-	} else {				/* (future) targettime is after starttime */
-	    if (targettime_ns <= starttime_ns) {
-		relativeage_s = starttime_s - targettime_s + 1;
-		relativeage_ns = NANOSECONDSPERSECOND - (starttime_ns - targettime_ns);
-	    } else {
-		relativeage_s = starttime_s - targettime_s;
-		relativeage_ns = targettime_ns - starttime_ns;
+    numregexes = mergedflag = 0;
+    if (nummerged > 1) {
+	if ((mergedstr=(char*)malloc(mergedlength)) == NULL) {
+	    perror("E: Could not malloc merged ERE");
+	    exit(1);
+	}
+	cptr = mergedstr;
+	for (idx=0; idx<numstrs; idx++) {
+	    if (!backrefflagtable[idx]) {
+		cptr += sprintf(cptr, "%s(%s)", cptr == mergedstr ? "" : "|", erestrtable[idx]);
 	    }
 	}
-
-	convert_time_s_to_date_string(targettime_s, datestr);
-	fprintf(stderr, "i: target time: %15ld.%09lds ~= %s\n", targettime_s, targettime_ns, datestr);
-	fprintf(stderr, "i: %13.5fD ~= %10ld.%09lds last %s %s target time ('%s')\n",
-	    (float)(starttime_s-targettime_s)/SECONDSPERDAY, relativeage_s,
-	    relativeage_ns, accesstimeflag ? "accessed" : "modified",
-	    newerthantargetflag ? "after (newer than)" : "before (older than)", timeinfostr);
-	list_starttime();
-	fflush(stderr);
+	if (regcomp(&regextable[0], mergedstr, cflags|REG_NOSUB) == 0) {
+	    numregexes = mergedflag = 1;
+	}
+	free(mergedstr);
+    }
+    for (idx=0; idx<numstrs; idx++) {		/* each ERE was already compiled OK on its own */
+	if ((!mergedflag || backrefflagtable[idx]) && regcomp(&regextable[numregexes], erestrtable[idx], cflags) == 0) {
+	    numregexes++;
+	}
     }
+    free(backrefflagtable);
+    *numregexesptr = numregexes;
+    return regextable;
 }
 
 
 /*******************************************************************************
-Set targettime to be the same as that of the reference object's last modification
-or last access time, as required.
+Build the Aho-Corasick automaton of the literals of the ERE set's members. The trie
+is built first, then (breadth first) each node's failure transitions are filled in,
+so every node has a next node for every ASCII byte and matching is a table lookup.
 *******************************************************************************/
-void set_target_time_by_object_time(char *targetobjectstr, char cmdlineoptchar) {
-    struct stat	statinfo;
-    char	datestr[MAXDATESTRLENGTH];
-
-    if (*targetobjectstr == NEGATIVESIGNCHAR) {
-	/* eg, "-M -foo" find objects last modified BEFORE foo was (OLDER than) */
-	newerthantargetflag = 0;
-	targetobjectstr++;
-    } else {
-	/* eg, "-M [+]foo" find objects last modified AFTER foo was (OLDER than) */
-	newerthantargetflag = 1;
-	if (*targetobjectstr == POSITIVESIGNCHAR) {
-	    targetobjectstr++;
-	}
+void build_ere_set_automaton(Ereset *ereset) {
+    Acnode	*nodeptr;
+    Ereinfo	*memberptr;
+    int		*failtable, *queuetable;
+    int		maxnumnodes, memberidx, node, child, fail, queuehead, queuetail, c;
+    size_t	idx;
+
+    maxnumnodes = 1;
+    for (memberidx=0; memberidx<ereset->nummembers; memberidx++) {
+	maxnumnodes += (int)ereset->membertable[memberidx].literallength;
     }
-
-    if (*targetobjectstr && (lstat(targetobjectstr, &statinfo) != -1)) {
-	if (cmdlineoptchar == REFMODTIMECHAR) {
-	    accesstimeflag = 0;
-	    targettime_s = statinfo.st_mtime;
-	    targettime_ns = statinfo.st_mtim.tv_nsec;
-	} else {
-	    accesstimeflag = 1;
-	    targettime_s = statinfo.st_atime;
-	    targettime_ns = statinfo.st_atim.tv_nsec;
-	}
-    } else {
-	fprintf(stderr, "E: Cannot access '%s'\n", targetobjectstr);
+    if ((ereset->acnodetable=(Acnode*)malloc(maxnumnodes*sizeof(Acnode))) == NULL ||
+	(ereset->nextmembertable=(int*)malloc((ereset->nummembers+1)*sizeof(int))) == NULL ||
+	(failtable=(int*)malloc(maxnumnodes*sizeof(int))) == NULL ||
+	(queuetable=(int*)malloc(maxnumnodes*sizeof(int))) == NULL) {
+	perror("E: Could not malloc ERE set automaton");
 	exit(1);
     }
 
-    if (verbosity > 1) {
-	fprintf(stderr, "i: last %s %s than '%s'\n", accesstimeflag ? "accessed" : "modified",
-	    newerthantargetflag ? "after (newer than)" : "before (older than)", targetobjectstr);
-	convert_time_s_to_date_string(targettime_s, datestr);
-	fprintf(stderr, "i: target time: %15ld.%09lds ~= %s\n", targettime_s, targettime_ns, datestr);
-	list_starttime();
-	fflush(stderr);
+    /* the trie: node 0 is the root */
+    ereset->numacnodes = 1;
+    memset(ereset->acnodetable[0].next, -1, sizeof(ereset->acnodetable[0].next));
+    ereset->acnodetable[0].memberidx = ereset->acnodetable[0].dictnode = -1;
+    for (memberidx=0; memberidx<ereset->nummembers; memberidx++) {
+	memberptr = &ereset->membertable[memberidx];
+	if (memberptr->literalkind == ERELITERALNONE) {
+	    continue;
+	}
+	node = 0;
+	for (idx=0; idx<memberptr->literallength; idx++) {
+	    c = (unsigned char)memberptr->literal[idx];
+	    if (ereset->acnodetable[node].next[c] < 0) {
+		nodeptr = &ereset->acnodetable[ereset->numacnodes];
+		memset(nodeptr->next, -1, sizeof(nodeptr->next));
+		nodeptr->memberidx = nodeptr->dictnode = -1;
+		ereset->acnodetable[node].next[c] = ereset->numacnodes++;
+	    }
+	    node = ereset->acnodetable[node].next[c];
+	}
+	ereset->nextmembertable[memberidx] = ereset->acnodetable[node].memberidx;
+	ereset->acnodetable[node].memberidx = memberidx;
     }
 
-    if (newerthantargetflag) {
-        if (targettime_ns < NANOSECONDSPERSECOND-1) {	/* +1ns for NEWER than (NOT the same age!) */
-	    targettime_ns += 1;
-	} else {			/* eg, 340.999999999 -> 341.000000000 */
-	    targettime_s += 1;
-	    targettime_ns = 0;
+    /* the failure transitions & dictionary links, breadth first */
+    queuehead = queuetail = 0;
+    for (c=0; c<NUMACCHARS; c++) {
+	if ((child=ereset->acnodetable[0].next[c]) < 0) {
+	    ereset->acnodetable[0].next[c] = 0;
+	} else {
+	    failtable[child] = 0;
+	    queuetable[queuetail++] = child;
 	}
-    } else {						/* -1ns for OLDER than (NOT the same age!) */
-        if (targettime_ns != 0) {
-	    targettime_ns -= 1;
-	} else {			/* eg, 341.000000000 -> 340.999999999 */
-	    targettime_s -= 1;
-	    targettime_ns = NANOSECONDSPERSECOND-1;
+    }
+    while (queuehead < queuetail) {
+	node = queuetable[queuehead++];
+	fail = failtable[node];
+	nodeptr = &ereset->acnodetable[node];
+	nodeptr->dictnode = ereset->acnodetable[fail].memberidx >= 0 ? fail : ereset->acnodetable[fail].dictnode;
+	for (c=0; c<NUMACCHARS; c++) {
+	    if ((child=nodeptr->next[c]) < 0) {
+		nodeptr->next[c] = ereset->acnodetable[fail].next[c];
+	    } else {
+		failtable[child] = ereset->acnodetable[fail].next[c];
+		queuetable[queuetail++] = child;
+	    }
 	}
     }
+    free(failtable);
+    free(queuetable);
 }
 
 
 /*******************************************************************************
-Set the extended regular expression (pattern) to be used to match the object names.
+Read EREs, one per line, from the file filename (empty lines are ignored) and add
+them to the name search as one entry: with matchcode REG_MATCH (-F), objects whose
+names match any of them are included; with REG_NOMATCH (-E), they are excluded.
+Each ERE is compiled on its own (to report errors), then the set is compiled into
+an Aho-Corasick automaton of their literals plus merged regexes (see match_ere_set).
 *******************************************************************************/
-#define MAXREGCOMPERRMSGLEN	64
-void set_extended_regular_expression(char *erestr, int matchcode) {
+void read_extended_regular_expressions(char *filename, int matchcode) {
+    FILE	*fileptr;
+    Ereset	*ereset;
+    Ereinfo	*memberptr;
+    char	**erestrtable, **reststrtable;
+    char	*linestr;
+    size_t	linesize;
+    ssize_t	linelength;
+    int		maxnumstrs, numstrs, numreststrs, linenum, cflags, regcompretval;
     char	regcomperrmsg[MAXREGCOMPERRMSGLEN];
-    int		cflags;
-    int		regcompretval;
 
-    if (numeres >= MAXNUMERES) {	/* number of EREs */
-	printf("E: Only %d extended regular expressions are allowed\n", MAXNUMERES);
+    if ((fileptr=fopen(filename, "r")) == NULL) {
+	fprintf(stderr, "E: Could not open ERE file '%s': %s\n", filename, strerror(errno));
 	exit(1);
     }
-
-    if (ignorecaseflag) {
-	cflags = REG_EXTENDED|REG_ICASE;
-    } else {
-	cflags = REG_EXTENDED;
+    cflags = ignorecaseflag ? REG_EXTENDED|REG_ICASE : REG_EXTENDED;
+
+    maxnumstrs = numstrs = linenum = 0;
+    erestrtable = NULL;
+    linestr = NULL;
+    linesize = 0;
+    while ((linelength=getline(&linestr, &linesize, fileptr)) != -1) {
+	linenum++;
+	if (linelength > 0 && linestr[linelength-1] == '\n') {
+	    linestr[--linelength] = '\0';
+	}
+	if (linelength == 0) {
+	    continue;
+	}
+	if (numstrs >= maxnumstrs) {
+	    maxnumstrs = maxnumstrs > 0 ? maxnumstrs * 2 : INITMAXNUMERES;
+	    if ((erestrtable=(char**)realloc(erestrtable, maxnumstrs*sizeof(char*))) == NULL) {
+		perror("E: Could not realloc ERE string table");
+		exit(1);
+	    }
+	}
+	if ((erestrtable[numstrs]=strdup(linestr)) == NULL) {
+	    perror("E: Could not strdup ERE");
+	    exit(1);
+	}
+	numstrs++;
     }
+    free(linestr);
+    fclose(fileptr);
 
-    if ((regcompretval=regcomp(&eretable[numeres].compiledere, erestr, cflags)) != 0) {
-	regerror(regcompretval, &eretable[numeres].compiledere, regcomperrmsg, MAXREGCOMPERRMSGLEN);
-	printf("E: Regular expression error for '%s': %s\n", erestr, regcomperrmsg);
+    if ((ereset=(Ereset*)calloc(1, sizeof(Ereset))) == NULL ||
+	(ereset->membertable=(Ereinfo*)calloc(numstrs+1, sizeof(Ereinfo))) == NULL ||
+	(reststrtable=(char**)malloc((numstrs+1)*sizeof(char*))) == NULL) {
+	perror("E: Could not calloc ERE set");
 	exit(1);
     }
-    eretable[numeres++].matchcode = matchcode;
+    ereset->icaseflag = ignorecaseflag;
+    ereset->multibyteflag = MB_CUR_MAX > 1;
+    ereset->nummembers = numstrs;
+    numreststrs = 0;
+    for (linenum=0; linenum<numstrs; linenum++) {
+	memberptr = &ereset->membertable[linenum];
+	if ((regcompretval=regcomp(&memberptr->compiledere, erestrtable[linenum], cflags)) != 0) {
+	    regerror(regcompretval, &memberptr->compiledere, regcomperrmsg, MAXREGCOMPERRMSGLEN);
+	    printf("E: Regular expression error for '%s' in '%s': %s\n", erestrtable[linenum], filename, regcomperrmsg);
+	    exit(1);
+	}
+	regfree(&memberptr->compiledere);	/* only the merged regexes are used */
+	memberptr->icaseflag = ignorecaseflag;
+	set_ere_literal(erestrtable[linenum], memberptr);
+	if (memberptr->literalkind == ERELITERALNONE) {
+	    ereset->numnoliteralmembers++;
+	}
+	if (memberptr->literalkind == ERELITERALNONE || memberptr->literalkind == ERELITERALFILTER) {
+	    reststrtable[numreststrs++] = erestrtable[linenum];
+	}
+    }
+    build_ere_set_automaton(ereset);
+    ereset->restregextable = compile_merged_eres(reststrtable, numreststrs, cflags, &ereset->numrestregexes);
+    ereset->allregextable = compile_merged_eres(erestrtable, numstrs, cflags, &ereset->numallregexes);
+    for (linenum=0; linenum<numstrs; linenum++) {
+	free(erestrtable[linenum]);
+    }
+    free(erestrtable);
+    free(reststrtable);
+
+    grow_ere_table();
+    memset(&eretable[numeres], 0, sizeof(Ereinfo));
+    eretable[numeres].matchcode = matchcode;
+    eretable[numeres].literalkind = ERELITERALNONE;
+    eretable[numeres++].ereset = ereset;
 }
 
 
@@ -1142,31 +6220,52 @@ void command_line_long_to_short(char *longopt) {
 	{ "-A", "--acc-ref"	, 7 },
 	{ "-P", "--and-pattern" , 7 },
 	{ "-X", "--and-exclude"	, 7 },
+	{ "-b", "--birth-info"	, 3 },
+	{ "-C", "--chg-info"	, 4 },
+	{ "-c", "--client"	, 4 },
+	{ "-J", "--device-jobs"	, 5 },	/* must precede --depth */
 	{ "-D", "--depth"	, 4 },
 	{ "-d", "--directories"	, 4 },
+	{ "-E", "--exclude-from",10 },	/* must precede --exclude */
 	{ "-x", "--exclude"	, 3 },
+	{ "-G", "--or"		, 4 },
 	{ "-f", "--files"	, 3 },
 	{ "-h", "--human-1024"	,11 },
 	{ "-H", "--human-1000"	,11 },
+	{ "-I", "--index"	, 4 },	/* must precede --ignore-case */
 	{ "-i", "--ignore-case"	, 3 },
+	{ "-j", "--jobs"	, 3 },
+	{ "-l", "--limit"	, 3 },
 	{ "-m", "--mod-info"	, 7 },
 	{ "-M", "--mod-ref"	, 7 },
-	{ "-n", "--nanoseconds"	, 3 },
+	{ "-n", "--nanoseconds"	, 4 },	/* --n... is also --no-sort, --no-sync & --not */
+	{ "-O", "--no-sort"	, 7 },
+	{ "-y", "--no-sync"	, 7 },
+	{ "-e", "--not"		, 5 },
 	{ "-o", "--others"	, 3 },
+	{ "-F", "--pattern-from",10 },	/* must precede --pattern */
+	{ "-K", "--prune"	, 4 },	/* must precede --pattern */
 	{ "-p", "--pattern"	, 3 },
+	{ "-Q", "--queries"	, 6 },	/* must precede --queue-depth */
+	{ "-q", "--queue-depth"	, 3 },
 	{ "-r", "--recursive"	, 5 },
 	{ "-R", "--reverse"	, 5 },
 	{ "-s", "--seconds"	, 4 },
+	{ "-W", "--skip-fstype"	, 4 },
 	{ "-z", "--size"	, 4 },
 	{ "-N", "--sort-by-name",11 },
 	{ "-S", "--sort-by-size",11 },
 	{ "-L", "--symlinks"	, 4 },
 	{ "-t", "--target"	, 4 },
+	{ "-k", "--time-key"	, 4 },
 	{ "-T", "--types"	, 4 },
+	{ "-Z", "--unique"	, 6 },	/* must precede --units */
 	{ "-u", "--units"	, 4 },
 	{ "-U", "--user"	, 4 },
 	{ "-V", "--variable"	, 4 },
 	{ "-v", "--verbose"	, 4 },
+	{ "-w", "--watch"	, 3 },
+	{ "-Y", "--xdev"	, 3 },
     };
 
     for (optiontableidx=0; optiontableidx<sizeof(optiontable)/sizeof(Optiontype); optiontableidx++) {
@@ -1275,6 +6374,13 @@ void set_cmd_line_envvar(const char *inputstr) {
 		}
 		*envvartable[idx].valueptr = malloc(strlen(chptr)+1);
 		strcpy(*envvartable[idx].valueptr, chptr);
+		if (!strcmp(inputstr, FF_DIRBUFSIZESTR)) {
+		    set_directory_buffer_size();
+		} else if (!strcmp(inputstr, FF_PARALLELSORTSTR)) {
+		    set_parallel_sort_minimum();
+		} else if (!strcmp(inputstr, FF_AGEFORMATSTR) || !strcmp(inputstr, FF_DATETIMEFORMATSTR)) {
+		    set_output_format_flags();
+		}
 		foundflag = 1;
 	    }
 	}
@@ -1328,12 +6434,96 @@ Set seclectsizecontrol to choose:
   >= 0: select objects that are >= than the specified size
 *******************************************************************************/
 void set_select_size(const char *optarg) {
-    if (*optarg == NEGATIVESIGNCHAR) {
-	selectsizecontrol = SELECTSMALLERSIZES;
-	selectobjectsize = strtoul(optarg+1, NULL, 10);
+    Selectpredicate	*predicateptr = add_select_predicate(PREDSIZE, 0);
+    const char		*separatorptr;
+
+    if ((separatorptr=strstr(optarg, RANGESEPARATORSTR)) != NULL) {	/* eg, 1000..2000 */
+	predicateptr->lowsize = strtoul(optarg, NULL, 10);
+	predicateptr->highsize = strtoul(separatorptr+sizeof(RANGESEPARATORSTR)-1, NULL, 10);
+	if (predicateptr->lowsize > predicateptr->highsize) {
+	    off_t	size = predicateptr->lowsize;
+
+	    predicateptr->lowsize = predicateptr->highsize;
+	    predicateptr->highsize = size;
+	}
+    } else if (*optarg == NEGATIVESIGNCHAR) {
+	predicateptr->lowsize = 0;
+	predicateptr->highsize = strtoul(optarg+1, NULL, 10);
     } else {
-	selectsizecontrol = SELECTLARGERSIZES;
-	selectobjectsize = strtoul(optarg, NULL, 10);
+	predicateptr->lowsize = strtoul(optarg, NULL, 10);
+	predicateptr->highsize = MAXOBJECTSIZE;
+    }
+}
+
+
+/*******************************************************************************
+Set the number of threads used to traverse directory trees (-j).
+*******************************************************************************/
+void set_number_of_threads(const char *optarg) {
+    char	*endptr;
+    long	number;
+
+    number = strtol(optarg, &endptr, 10);
+    if (*optarg == '\0' || *endptr != '\0' || number < 1 || number > MAXNUMTHREADS) {
+	fprintf(stderr, "E: Illegal number of threads '%s' (must be 1 to %d)\n", optarg, MAXNUMTHREADS);
+	exit(1);
+    }
+    numthreads = number;
+}
+
+
+/*******************************************************************************
+Set the io_uring queue depth (-q): the maximum number of objects stat'ed in each
+batch. 0 turns io_uring off. Where io_uring is not available, warn and ignore it.
+*******************************************************************************/
+void set_uring_queue_depth(const char *optarg) {
+    char	*endptr;
+    long	number;
+
+    number = strtol(optarg, &endptr, 10);
+    if (*optarg == '\0' || *endptr != '\0' || number < 0 || number > MAXURINGQUEUEDEPTH) {
+	fprintf(stderr, "E: Illegal queue depth '%s' (must be 0 to %d)\n", optarg, MAXURINGQUEUEDEPTH);
+	exit(1);
+    }
+#if HAVEIOURING
+    uringqueuedepth = number;
+#else
+    if (number > 0 && !uringwarningflag) {
+	fprintf(stderr, "W: io_uring is not available on this system, ignoring -q\n");
+	uringwarningflag = 1;
+    }
+#endif
+}
+
+
+/*******************************************************************************
+Set the maximum number of objects to list (-l/--limit). When it is set before
+any targets are processed, only that many objects (the first in sort order) are
+kept while traversing - see process_object. Otherwise, all the objects are kept,
+but only that many are listed.
+*******************************************************************************/
+void set_object_limit(const char *optarg) {
+    char	*endptr;
+    long	number;
+
+    number = strtol(optarg, &endptr, 10);
+    if (*optarg == '\0' || *endptr != '\0' || number < 1 || number > INT_MAX) {
+	fprintf(stderr, "E: Illegal limit '%s' (must be 1 to %d)\n", optarg, INT_MAX);
+	exit(1);
+    }
+    objectlimit = number;
+    limitheapflag = numtargets == 0 && objecttable.numobjs == 0;
+}
+
+
+/*******************************************************************************
+-N, -S & -R change the sort order. If -l/--limit has already dropped objects
+(using the previous sort order), the objects listed could be the wrong ones.
+*******************************************************************************/
+void check_sort_order_change() {
+    if (limitprunedflag) {
+	fprintf(stderr, "E: -N, -S & -R must precede the targets when -l|--limit is used\n");
+	exit(1);
     }
 }
 
@@ -1390,6 +6580,8 @@ void set_select_user(char *optarg) {
 	}
     }
 
+    add_select_predicate(PREDUID, 0)->uid = selectuid;
+
     if (verbosity > 1 && selectuid != (unsigned int)REJECTALLUSERS) {
 	fprintf(stderr, "i: Searching for username/userID '%s' (userID:%d)\n", optarg, selectuid);
     }
@@ -1439,48 +6631,25 @@ void configure_locale() {
 
 
 /*******************************************************************************
-Parse the command line arguments left to right, processing them in order. See the usage message.
+Process the command line options and targets (in left-to-right order), then list
+the selected objects. Returns the return code. A daemon (-w/--watch) query's
+arguments are processed here too.
 *******************************************************************************/
-int main(int argc, char *argv[]) {
+int process_command_line(int argc, char *argv[]) {
     extern char		*optarg;
-    extern int		optind, optopt, opterr;
-    int			optchar, optidx;
-    struct rlimit	filelimits;
-
-    configure_locale();
-
-    if (argc <= 1) {
-	display_usage_message(argv[0]);
-	exit(0);
-    }
-
-    if ((objectinfotable=(Objectinfo*)calloc(INITMAXNUMOBJS, sizeof(Objectinfo))) == NULL) {
-	perror("E: Could not calloc initial object info table");
-	exit(1);
-    }
-
-    /* replace any --longarg(s) with the equivalent -l (short argument(s)) */
-    for (optidx=1; optidx<argc; optidx++) {
-	if (!strncmp(argv[optidx], "--", 2)) {
-	    command_line_long_to_short(argv[optidx]);
-	}
-    }
-
-    /* Get the file desciptor soft limit */
-    if (getrlimit(RLIMIT_NOFILE, &filelimits) == -1) {
-        perror("E: could not get file descriptor limits");
-	exit(1);
-    } else {
-	filedescriptorsavailable = filelimits.rlim_cur - 3; /* 3: one each for stdin stdout & stderr */
-    }
-
-    grab_environment_variables();
-    set_starttime();
+    extern int		optind;
+    int			optchar;
 
     /* Both while loops and the if (below) are required because command line options
     and arguments can be interspersed and are processed in (left-to-right) order */
     while (optind < argc) {
 	while ((optchar = getopt(argc, argv, GETOPTSTR)) != -1) {
+	    if (watchqueryflag && strchr(WATCHQUERYBADOPTIONS, optchar) != NULL) {
+		fprintf(stderr, "E: -%c cannot be used in a -c/--client query, aborting\n", optchar);
+		exit(1);
+	    } else if (optchar != 'w' && optchar != 'v' && optchar != 't') {
+		numqueryoptions++;
+	    }
 	    switch (optchar) {
 		case 'd': directoryflag		= !directoryflag;				break;
 		case 'f': regularfileflag	= !regularfileflag;				break;
@@ -1491,45 +6660,72 @@ int main(int argc, char *argv[]) {
 		case 'P': set_extended_regular_expression(optarg, REG_MATCH); 			break;
 		case 'x': numeres = 0; set_extended_regular_expression(optarg, REG_NOMATCH);	break;
 		case 'X': set_extended_regular_expression(optarg, REG_NOMATCH);			break;
-		case 't': process_path(optarg, 0); numtargets++;				break;
+		case 'F': read_extended_regular_expressions(optarg, REG_MATCH);			break;
+		case 'E': read_extended_regular_expressions(optarg, REG_NOMATCH);		break;
+		case 'K': set_prune_expression(optarg);						break;
+		case 't': process_target(optarg);						break;
+		case 'I': indexfilename = optarg;						break;
+		case 'w': set_watch_socket(optarg);						break;
+		case 'c': run_client(optarg, argc, argv);					break;
+		case 'Q': run_batch_queries(optarg, argc);					break;
 		case 'D': maxrecursiondepth = abs(atoi(optarg));				break;
+		case 'j': set_number_of_threads(optarg);					break;
+		case 'q': set_uring_queue_depth(optarg);					break;
 		case 'V': set_cmd_line_envvar(optarg);						break;
-		case 'a': set_target_time_by_cmd_line_arg(optarg, optchar);			break;
-		case 'm': set_target_time_by_cmd_line_arg(optarg, optchar);			break;
+		case 'a': set_select_time(optarg, optchar);					break;
+		case 'b': set_select_time(optarg, optchar);					break;
+		case 'm': set_select_time(optarg, optchar);					break;
+		case 'C': set_select_time(optarg, optchar);					break;
+		case 'e': negatenextflag	= !negatenextflag;				break;
+		case 'G': ornextflag		= 1;						break;
+		case 'k': set_time_key(optarg);							break;
 		case 'A': set_target_time_by_object_time(optarg, optchar);			break;
 		case 'M': set_target_time_by_object_time(optarg, optchar);			break;
 		case 'h': humanunittable = humanunit1024table;
 		    numhumanunits = sizeof(humanunit1024table)/sizeof(Unitinfo);		break;
 		case 'H': humanunittable = humanunit1000table;
 		    numhumanunits = sizeof(humanunit1000table)/sizeof(Unitinfo);		break;
-		case 'N': compare_object_function_ptr = &compare_object_name_info;		break;
-		case 'S': compare_object_function_ptr = &compare_object_size_info;		break;
+		case 'O': nosortflag = 1;							break;
+		case 'N': check_sort_order_change(); compare_object_function_ptr = &compare_object_name_info; break;
+		case 'S': check_sort_order_change(); compare_object_function_ptr = &compare_object_size_info; break;
+		case 'l': set_object_limit(optarg);						break;
 		case 'z': set_select_size(optarg);						break;
 		case 'U': set_select_user(optarg);						break;
 		case 'n': displaynsecflag = 1;							break;
 		case 's': displaysecondsflag = 1;						break;
 		case 'u': secondsunitchar = SECONDSUNITCHAR; bytesunitchar = BYTESUNITCHAR;	break;
 		case 'L': followsymlinksflag = !followsymlinksflag;				break;
+		case 'y': nosyncflag = !nosyncflag;						break;
+		case 'Z': uniqueflag = !uniqueflag;						break;
+		case 'Y': xdevflag = !xdevflag;
+		    devicecheckflag = maxdevicethreads > 0 || xdevflag || numskipdevices > 0;		break;
+		case 'W': set_skip_file_system_types(optarg);					break;
+		case 'J': set_device_threads(optarg);						break;
 		case 'T': displaytypesflag = 1;							break;
-		case 'R': sortmultiplier = -1;							break;
+		case 'R': check_sort_order_change(); sortmultiplier = -1;			break;
 		case 'v': verbosity++;								break;
 	    }
 	}
 
 	if (optind < argc) {	/* See above comment. Yes, this is required! */
-	    process_path(argv[optind], 0);
-	    numtargets++;
+	    process_target(argv[optind]);
 	    optind++;
 	}
     }
 
     /* Display starttime unless it's already been displayed (i.e., by setting targettime and/or starttime) */
+#if HAVEINOTIFY
+    if (watchsocketname != NULL) {
+	run_daemon();
+    }
+#endif
+
     if (verbosity > 1 && targettime_s == DEFAULTAGE && targettime_ns == DEFAULTAGE && !strcmp(starttimestr, NOWSTR)) {
 	list_starttime();
     }
 
     if (verbosity > 1) {
-	fprintf(stderr, "i: %d objects found\n", numobjsfound);
+	fprintf(stderr, "i: %d objects found\n", nosortflag ? numobjslisted : objecttable.numobjs);
     }
 
     if (numtargets > 0) {
@@ -1546,3 +6742,35 @@ int main(int argc, char *argv[]) {
 
     return returncode;
 }
+
+
+/*******************************************************************************
+Parse the command line arguments left to right, processing them in order. See the usage message.
+*******************************************************************************/
+int main(int argc, char *argv[]) {
+    int			optidx;
+
+    configure_locale();
+
+    if (argc <= 1) {
+	display_usage_message(argv[0]);
+	exit(0);
+    }
+
+    init_object_table(&objecttable);
+
+    /* replace any --longarg(s) with the equivalent -l (short argument(s)) */
+    for (optidx=1; optidx<argc; optidx++) {
+	if (!strncmp(argv[optidx], "--", 2)) {
+	    command_line_long_to_short(argv[optidx]);
+	}
+    }
+
+    grab_environment_variables();
+    set_directory_buffer_size();
+    set_parallel_sort_minimum();
+    set_output_format_flags();
+    set_starttime();
+
+    return process_command_line(argc, argv);
+}